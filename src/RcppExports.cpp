@@ -10,6 +10,97 @@ Rcpp::Rostream<true>&  Rcpp::Rcout = Rcpp::Rcpp_cout_get();
 Rcpp::Rostream<false>& Rcpp::Rcerr = Rcpp::Rcpp_cerr_get();
 #endif
 
+// alignment_cpp
+SEXP alignment_cpp(NumericMatrix x, NumericMatrix y, const std::string& distance, bool diagonal, bool weighted, bool ignore_blocks, double bandwidth);
+RcppExport SEXP _distantia_alignment_cpp(SEXP xSEXP, SEXP ySEXP, SEXP distanceSEXP, SEXP diagonalSEXP, SEXP weightedSEXP, SEXP ignore_blocksSEXP, SEXP bandwidthSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< NumericMatrix >::type x(xSEXP);
+    Rcpp::traits::input_parameter< NumericMatrix >::type y(ySEXP);
+    Rcpp::traits::input_parameter< const std::string& >::type distance(distanceSEXP);
+    Rcpp::traits::input_parameter< bool >::type diagonal(diagonalSEXP);
+    Rcpp::traits::input_parameter< bool >::type weighted(weightedSEXP);
+    Rcpp::traits::input_parameter< bool >::type ignore_blocks(ignore_blocksSEXP);
+    Rcpp::traits::input_parameter< double >::type bandwidth(bandwidthSEXP);
+    rcpp_result_gen = Rcpp::wrap(alignment_cpp(x, y, distance, diagonal, weighted, ignore_blocks, bandwidth));
+    return rcpp_result_gen;
+END_RCPP
+}
+// alignment_sum_cpp
+double alignment_sum_cpp(SEXP alignment);
+RcppExport SEXP _distantia_alignment_sum_cpp(SEXP alignmentSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type alignment(alignmentSEXP);
+    rcpp_result_gen = Rcpp::wrap(alignment_sum_cpp(alignment));
+    return rcpp_result_gen;
+END_RCPP
+}
+// alignment_trim_cpp
+SEXP alignment_trim_cpp(SEXP alignment);
+RcppExport SEXP _distantia_alignment_trim_cpp(SEXP alignmentSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type alignment(alignmentSEXP);
+    rcpp_result_gen = Rcpp::wrap(alignment_trim_cpp(alignment));
+    return rcpp_result_gen;
+END_RCPP
+}
+// alignment_auto_sum_cpp
+double alignment_auto_sum_cpp(SEXP alignment, NumericMatrix x, NumericMatrix y, const std::string& distance, bool ignore_blocks);
+RcppExport SEXP _distantia_alignment_auto_sum_cpp(SEXP alignmentSEXP, SEXP xSEXP, SEXP ySEXP, SEXP distanceSEXP, SEXP ignore_blocksSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type alignment(alignmentSEXP);
+    Rcpp::traits::input_parameter< NumericMatrix >::type x(xSEXP);
+    Rcpp::traits::input_parameter< NumericMatrix >::type y(ySEXP);
+    Rcpp::traits::input_parameter< const std::string& >::type distance(distanceSEXP);
+    Rcpp::traits::input_parameter< bool >::type ignore_blocks(ignore_blocksSEXP);
+    rcpp_result_gen = Rcpp::wrap(alignment_auto_sum_cpp(alignment, x, y, distance, ignore_blocks));
+    return rcpp_result_gen;
+END_RCPP
+}
+// alignment_update_dist_cpp
+SEXP alignment_update_dist_cpp(SEXP alignment, NumericMatrix x, NumericMatrix y, const std::string& distance);
+RcppExport SEXP _distantia_alignment_update_dist_cpp(SEXP alignmentSEXP, SEXP xSEXP, SEXP ySEXP, SEXP distanceSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type alignment(alignmentSEXP);
+    Rcpp::traits::input_parameter< NumericMatrix >::type x(xSEXP);
+    Rcpp::traits::input_parameter< NumericMatrix >::type y(ySEXP);
+    Rcpp::traits::input_parameter< const std::string& >::type distance(distanceSEXP);
+    rcpp_result_gen = Rcpp::wrap(alignment_update_dist_cpp(alignment, x, y, distance));
+    return rcpp_result_gen;
+END_RCPP
+}
+// alignment_df_cpp
+DataFrame alignment_df_cpp(SEXP alignment);
+RcppExport SEXP _distantia_alignment_df_cpp(SEXP alignmentSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type alignment(alignmentSEXP);
+    rcpp_result_gen = Rcpp::wrap(alignment_df_cpp(alignment));
+    return rcpp_result_gen;
+END_RCPP
+}
+// alignment_cache_cpp
+NumericVector alignment_cache_cpp(Nullable<NumericVector> max_mb, bool clear);
+RcppExport SEXP _distantia_alignment_cache_cpp(SEXP max_mbSEXP, SEXP clearSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< Nullable<NumericVector> >::type max_mb(max_mbSEXP);
+    Rcpp::traits::input_parameter< bool >::type clear(clearSEXP);
+    rcpp_result_gen = Rcpp::wrap(alignment_cache_cpp(max_mb, clear));
+    return rcpp_result_gen;
+END_RCPP
+}
 // auto_distance_cpp
 double auto_distance_cpp(NumericMatrix x, const std::string& distance);
 RcppExport SEXP _distantia_auto_distance_cpp(SEXP xSEXP, SEXP distanceSEXP) {
@@ -194,8 +285,8 @@ BEGIN_RCPP
 END_RCPP
 }
 // cost_path_cpp
-DataFrame cost_path_cpp(NumericMatrix x, NumericMatrix y, const std::string& distance, bool diagonal, bool weighted, bool ignore_blocks, double bandwidth);
-RcppExport SEXP _distantia_cost_path_cpp(SEXP xSEXP, SEXP ySEXP, SEXP distanceSEXP, SEXP diagonalSEXP, SEXP weightedSEXP, SEXP ignore_blocksSEXP, SEXP bandwidthSEXP) {
+DataFrame cost_path_cpp(NumericMatrix x, NumericMatrix y, const std::string& distance, bool diagonal, bool weighted, bool ignore_blocks, double bandwidth, Nullable<CharacterVector> step_pattern, const std::string& window, double window_size, double slope, Nullable<IntegerVector> lower, Nullable<IntegerVector> upper);
+RcppExport SEXP _distantia_cost_path_cpp(SEXP xSEXP, SEXP ySEXP, SEXP distanceSEXP, SEXP diagonalSEXP, SEXP weightedSEXP, SEXP ignore_blocksSEXP, SEXP bandwidthSEXP, SEXP step_patternSEXP, SEXP windowSEXP, SEXP window_sizeSEXP, SEXP slopeSEXP, SEXP lowerSEXP, SEXP upperSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
@@ -206,7 +297,13 @@ BEGIN_RCPP
     Rcpp::traits::input_parameter< bool >::type weighted(weightedSEXP);
     Rcpp::traits::input_parameter< bool >::type ignore_blocks(ignore_blocksSEXP);
     Rcpp::traits::input_parameter< double >::type bandwidth(bandwidthSEXP);
-    rcpp_result_gen = Rcpp::wrap(cost_path_cpp(x, y, distance, diagonal, weighted, ignore_blocks, bandwidth));
+    Rcpp::traits::input_parameter< Nullable<CharacterVector> >::type step_pattern(step_patternSEXP);
+    Rcpp::traits::input_parameter< const std::string& >::type window(windowSEXP);
+    Rcpp::traits::input_parameter< double >::type window_size(window_sizeSEXP);
+    Rcpp::traits::input_parameter< double >::type slope(slopeSEXP);
+    Rcpp::traits::input_parameter< Nullable<IntegerVector> >::type lower(lowerSEXP);
+    Rcpp::traits::input_parameter< Nullable<IntegerVector> >::type upper(upperSEXP);
+    rcpp_result_gen = Rcpp::wrap(cost_path_cpp(x, y, distance, diagonal, weighted, ignore_blocks, bandwidth, step_pattern, window, window_size, slope, lower, upper));
     return rcpp_result_gen;
 END_RCPP
 }
@@ -419,21 +516,22 @@ BEGIN_RCPP
 END_RCPP
 }
 // importance_ls_cpp
-DataFrame importance_ls_cpp(NumericMatrix x, NumericMatrix y, const std::string& distance);
-RcppExport SEXP _distantia_importance_ls_cpp(SEXP xSEXP, SEXP ySEXP, SEXP distanceSEXP) {
+DataFrame importance_ls_cpp(NumericMatrix x, NumericMatrix y, const std::string& distance, int threads);
+RcppExport SEXP _distantia_importance_ls_cpp(SEXP xSEXP, SEXP ySEXP, SEXP distanceSEXP, SEXP threadsSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
     Rcpp::traits::input_parameter< NumericMatrix >::type x(xSEXP);
     Rcpp::traits::input_parameter< NumericMatrix >::type y(ySEXP);
     Rcpp::traits::input_parameter< const std::string& >::type distance(distanceSEXP);
-    rcpp_result_gen = Rcpp::wrap(importance_ls_cpp(x, y, distance));
+    Rcpp::traits::input_parameter< int >::type threads(threadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(importance_ls_cpp(x, y, distance, threads));
     return rcpp_result_gen;
 END_RCPP
 }
 // importance_dtw_legacy_cpp
-DataFrame importance_dtw_legacy_cpp(NumericMatrix y, NumericMatrix x, const std::string& distance, bool diagonal, bool weighted, bool ignore_blocks, double bandwidth);
-RcppExport SEXP _distantia_importance_dtw_legacy_cpp(SEXP ySEXP, SEXP xSEXP, SEXP distanceSEXP, SEXP diagonalSEXP, SEXP weightedSEXP, SEXP ignore_blocksSEXP, SEXP bandwidthSEXP) {
+DataFrame importance_dtw_legacy_cpp(NumericMatrix y, NumericMatrix x, const std::string& distance, bool diagonal, bool weighted, bool ignore_blocks, double bandwidth, int threads);
+RcppExport SEXP _distantia_importance_dtw_legacy_cpp(SEXP ySEXP, SEXP xSEXP, SEXP distanceSEXP, SEXP diagonalSEXP, SEXP weightedSEXP, SEXP ignore_blocksSEXP, SEXP bandwidthSEXP, SEXP threadsSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
@@ -444,13 +542,14 @@ BEGIN_RCPP
     Rcpp::traits::input_parameter< bool >::type weighted(weightedSEXP);
     Rcpp::traits::input_parameter< bool >::type ignore_blocks(ignore_blocksSEXP);
     Rcpp::traits::input_parameter< double >::type bandwidth(bandwidthSEXP);
-    rcpp_result_gen = Rcpp::wrap(importance_dtw_legacy_cpp(y, x, distance, diagonal, weighted, ignore_blocks, bandwidth));
+    Rcpp::traits::input_parameter< int >::type threads(threadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(importance_dtw_legacy_cpp(y, x, distance, diagonal, weighted, ignore_blocks, bandwidth, threads));
     return rcpp_result_gen;
 END_RCPP
 }
 // importance_dtw_cpp
-DataFrame importance_dtw_cpp(NumericMatrix x, NumericMatrix y, const std::string& distance, bool diagonal, bool weighted, bool ignore_blocks, double bandwidth);
-RcppExport SEXP _distantia_importance_dtw_cpp(SEXP xSEXP, SEXP ySEXP, SEXP distanceSEXP, SEXP diagonalSEXP, SEXP weightedSEXP, SEXP ignore_blocksSEXP, SEXP bandwidthSEXP) {
+DataFrame importance_dtw_cpp(NumericMatrix x, NumericMatrix y, const std::string& distance, bool diagonal, bool weighted, bool ignore_blocks, double bandwidth, int threads);
+RcppExport SEXP _distantia_importance_dtw_cpp(SEXP xSEXP, SEXP ySEXP, SEXP distanceSEXP, SEXP diagonalSEXP, SEXP weightedSEXP, SEXP ignore_blocksSEXP, SEXP bandwidthSEXP, SEXP threadsSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
@@ -461,7 +560,35 @@ BEGIN_RCPP
     Rcpp::traits::input_parameter< bool >::type weighted(weightedSEXP);
     Rcpp::traits::input_parameter< bool >::type ignore_blocks(ignore_blocksSEXP);
     Rcpp::traits::input_parameter< double >::type bandwidth(bandwidthSEXP);
-    rcpp_result_gen = Rcpp::wrap(importance_dtw_cpp(x, y, distance, diagonal, weighted, ignore_blocks, bandwidth));
+    Rcpp::traits::input_parameter< int >::type threads(threadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(importance_dtw_cpp(x, y, distance, diagonal, weighted, ignore_blocks, bandwidth, threads));
+    return rcpp_result_gen;
+END_RCPP
+}
+// knn_pairs_cpp
+IntegerMatrix knn_pairs_cpp(NumericMatrix xy, int k, int threads);
+RcppExport SEXP _distantia_knn_pairs_cpp(SEXP xySEXP, SEXP kSEXP, SEXP threadsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< NumericMatrix >::type xy(xySEXP);
+    Rcpp::traits::input_parameter< int >::type k(kSEXP);
+    Rcpp::traits::input_parameter< int >::type threads(threadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(knn_pairs_cpp(xy, k, threads));
+    return rcpp_result_gen;
+END_RCPP
+}
+// matrix_profile_cpp
+DataFrame matrix_profile_cpp(NumericMatrix x, int width, Nullable<NumericMatrix> y, int threads);
+RcppExport SEXP _distantia_matrix_profile_cpp(SEXP xSEXP, SEXP widthSEXP, SEXP ySEXP, SEXP threadsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< NumericMatrix >::type x(xSEXP);
+    Rcpp::traits::input_parameter< int >::type width(widthSEXP);
+    Rcpp::traits::input_parameter< Nullable<NumericMatrix> >::type y(ySEXP);
+    Rcpp::traits::input_parameter< int >::type threads(threadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(matrix_profile_cpp(x, width, y, threads));
     return rcpp_result_gen;
 END_RCPP
 }
@@ -561,8 +688,8 @@ BEGIN_RCPP
 END_RCPP
 }
 // psi_dtw_cpp
-double psi_dtw_cpp(NumericMatrix x, NumericMatrix y, const std::string& distance, bool diagonal, bool weighted, bool ignore_blocks, double bandwidth);
-RcppExport SEXP _distantia_psi_dtw_cpp(SEXP xSEXP, SEXP ySEXP, SEXP distanceSEXP, SEXP diagonalSEXP, SEXP weightedSEXP, SEXP ignore_blocksSEXP, SEXP bandwidthSEXP) {
+double psi_dtw_cpp(NumericMatrix x, NumericMatrix y, const std::string& distance, bool diagonal, bool weighted, bool ignore_blocks, double bandwidth, Nullable<CharacterVector> step_pattern, const std::string& window, double window_size, double slope, Nullable<IntegerVector> lower, Nullable<IntegerVector> upper);
+RcppExport SEXP _distantia_psi_dtw_cpp(SEXP xSEXP, SEXP ySEXP, SEXP distanceSEXP, SEXP diagonalSEXP, SEXP weightedSEXP, SEXP ignore_blocksSEXP, SEXP bandwidthSEXP, SEXP step_patternSEXP, SEXP windowSEXP, SEXP window_sizeSEXP, SEXP slopeSEXP, SEXP lowerSEXP, SEXP upperSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
@@ -573,13 +700,19 @@ BEGIN_RCPP
     Rcpp::traits::input_parameter< bool >::type weighted(weightedSEXP);
     Rcpp::traits::input_parameter< bool >::type ignore_blocks(ignore_blocksSEXP);
     Rcpp::traits::input_parameter< double >::type bandwidth(bandwidthSEXP);
-    rcpp_result_gen = Rcpp::wrap(psi_dtw_cpp(x, y, distance, diagonal, weighted, ignore_blocks, bandwidth));
+    Rcpp::traits::input_parameter< Nullable<CharacterVector> >::type step_pattern(step_patternSEXP);
+    Rcpp::traits::input_parameter< const std::string& >::type window(windowSEXP);
+    Rcpp::traits::input_parameter< double >::type window_size(window_sizeSEXP);
+    Rcpp::traits::input_parameter< double >::type slope(slopeSEXP);
+    Rcpp::traits::input_parameter< Nullable<IntegerVector> >::type lower(lowerSEXP);
+    Rcpp::traits::input_parameter< Nullable<IntegerVector> >::type upper(upperSEXP);
+    rcpp_result_gen = Rcpp::wrap(psi_dtw_cpp(x, y, distance, diagonal, weighted, ignore_blocks, bandwidth, step_pattern, window, window_size, slope, lower, upper));
     return rcpp_result_gen;
 END_RCPP
 }
 // psi_null_dtw_cpp
-NumericVector psi_null_dtw_cpp(NumericMatrix x, NumericMatrix y, const std::string& distance, bool diagonal, bool weighted, bool ignore_blocks, double bandwidth, int repetitions, const std::string& permutation, int block_size, int seed);
-RcppExport SEXP _distantia_psi_null_dtw_cpp(SEXP xSEXP, SEXP ySEXP, SEXP distanceSEXP, SEXP diagonalSEXP, SEXP weightedSEXP, SEXP ignore_blocksSEXP, SEXP bandwidthSEXP, SEXP repetitionsSEXP, SEXP permutationSEXP, SEXP block_sizeSEXP, SEXP seedSEXP) {
+NumericVector psi_null_dtw_cpp(NumericMatrix x, NumericMatrix y, const std::string& distance, bool diagonal, bool weighted, bool ignore_blocks, double bandwidth, int repetitions, const std::string& permutation, int block_size, int seed, Nullable<CharacterVector> step_pattern, const std::string& window, double window_size, double slope, Nullable<IntegerVector> lower, Nullable<IntegerVector> upper);
+RcppExport SEXP _distantia_psi_null_dtw_cpp(SEXP xSEXP, SEXP ySEXP, SEXP distanceSEXP, SEXP diagonalSEXP, SEXP weightedSEXP, SEXP ignore_blocksSEXP, SEXP bandwidthSEXP, SEXP repetitionsSEXP, SEXP permutationSEXP, SEXP block_sizeSEXP, SEXP seedSEXP, SEXP step_patternSEXP, SEXP windowSEXP, SEXP window_sizeSEXP, SEXP slopeSEXP, SEXP lowerSEXP, SEXP upperSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
@@ -594,12 +727,292 @@ BEGIN_RCPP
     Rcpp::traits::input_parameter< const std::string& >::type permutation(permutationSEXP);
     Rcpp::traits::input_parameter< int >::type block_size(block_sizeSEXP);
     Rcpp::traits::input_parameter< int >::type seed(seedSEXP);
-    rcpp_result_gen = Rcpp::wrap(psi_null_dtw_cpp(x, y, distance, diagonal, weighted, ignore_blocks, bandwidth, repetitions, permutation, block_size, seed));
+    Rcpp::traits::input_parameter< Nullable<CharacterVector> >::type step_pattern(step_patternSEXP);
+    Rcpp::traits::input_parameter< const std::string& >::type window(windowSEXP);
+    Rcpp::traits::input_parameter< double >::type window_size(window_sizeSEXP);
+    Rcpp::traits::input_parameter< double >::type slope(slopeSEXP);
+    Rcpp::traits::input_parameter< Nullable<IntegerVector> >::type lower(lowerSEXP);
+    Rcpp::traits::input_parameter< Nullable<IntegerVector> >::type upper(upperSEXP);
+    rcpp_result_gen = Rcpp::wrap(psi_null_dtw_cpp(x, y, distance, diagonal, weighted, ignore_blocks, bandwidth, repetitions, permutation, block_size, seed, step_pattern, window, window_size, slope, lower, upper));
+    return rcpp_result_gen;
+END_RCPP
+}
+// psi_dtw_knn_cpp
+DataFrame psi_dtw_knn_cpp(NumericMatrix x, SEXP tsl, int k, const std::string& distance, bool diagonal, double bandwidth, bool weighted, bool ignore_blocks, int threads);
+RcppExport SEXP _distantia_psi_dtw_knn_cpp(SEXP xSEXP, SEXP tslSEXP, SEXP kSEXP, SEXP distanceSEXP, SEXP diagonalSEXP, SEXP bandwidthSEXP, SEXP weightedSEXP, SEXP ignore_blocksSEXP, SEXP threadsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< NumericMatrix >::type x(xSEXP);
+    Rcpp::traits::input_parameter< SEXP >::type tsl(tslSEXP);
+    Rcpp::traits::input_parameter< int >::type k(kSEXP);
+    Rcpp::traits::input_parameter< const std::string& >::type distance(distanceSEXP);
+    Rcpp::traits::input_parameter< bool >::type diagonal(diagonalSEXP);
+    Rcpp::traits::input_parameter< double >::type bandwidth(bandwidthSEXP);
+    Rcpp::traits::input_parameter< bool >::type weighted(weightedSEXP);
+    Rcpp::traits::input_parameter< bool >::type ignore_blocks(ignore_blocksSEXP);
+    Rcpp::traits::input_parameter< int >::type threads(threadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(psi_dtw_knn_cpp(x, tsl, k, distance, diagonal, bandwidth, weighted, ignore_blocks, threads));
+    return rcpp_result_gen;
+END_RCPP
+}
+// psi_profile_cpp
+DataFrame psi_profile_cpp(NumericMatrix x, NumericMatrix y, int width, int stride, const std::string& distance, bool lock_step, bool diagonal, bool weighted, bool ignore_blocks, double bandwidth, int threads);
+RcppExport SEXP _distantia_psi_profile_cpp(SEXP xSEXP, SEXP ySEXP, SEXP widthSEXP, SEXP strideSEXP, SEXP distanceSEXP, SEXP lock_stepSEXP, SEXP diagonalSEXP, SEXP weightedSEXP, SEXP ignore_blocksSEXP, SEXP bandwidthSEXP, SEXP threadsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< NumericMatrix >::type x(xSEXP);
+    Rcpp::traits::input_parameter< NumericMatrix >::type y(ySEXP);
+    Rcpp::traits::input_parameter< int >::type width(widthSEXP);
+    Rcpp::traits::input_parameter< int >::type stride(strideSEXP);
+    Rcpp::traits::input_parameter< const std::string& >::type distance(distanceSEXP);
+    Rcpp::traits::input_parameter< bool >::type lock_step(lock_stepSEXP);
+    Rcpp::traits::input_parameter< bool >::type diagonal(diagonalSEXP);
+    Rcpp::traits::input_parameter< bool >::type weighted(weightedSEXP);
+    Rcpp::traits::input_parameter< bool >::type ignore_blocks(ignore_blocksSEXP);
+    Rcpp::traits::input_parameter< double >::type bandwidth(bandwidthSEXP);
+    Rcpp::traits::input_parameter< int >::type threads(threadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(psi_profile_cpp(x, y, width, stride, distance, lock_step, diagonal, weighted, ignore_blocks, bandwidth, threads));
+    return rcpp_result_gen;
+END_RCPP
+}
+// psi_dtw_stream_cpp
+SEXP psi_dtw_stream_cpp(NumericMatrix y, const std::string& distance, bool diagonal, bool weighted);
+RcppExport SEXP _distantia_psi_dtw_stream_cpp(SEXP ySEXP, SEXP distanceSEXP, SEXP diagonalSEXP, SEXP weightedSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< NumericMatrix >::type y(ySEXP);
+    Rcpp::traits::input_parameter< const std::string& >::type distance(distanceSEXP);
+    Rcpp::traits::input_parameter< bool >::type diagonal(diagonalSEXP);
+    Rcpp::traits::input_parameter< bool >::type weighted(weightedSEXP);
+    rcpp_result_gen = Rcpp::wrap(psi_dtw_stream_cpp(y, distance, diagonal, weighted));
+    return rcpp_result_gen;
+END_RCPP
+}
+// psi_dtw_stream_append_cpp
+NumericVector psi_dtw_stream_append_cpp(SEXP stream, NumericMatrix x);
+RcppExport SEXP _distantia_psi_dtw_stream_append_cpp(SEXP streamSEXP, SEXP xSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type stream(streamSEXP);
+    Rcpp::traits::input_parameter< NumericMatrix >::type x(xSEXP);
+    rcpp_result_gen = Rcpp::wrap(psi_dtw_stream_append_cpp(stream, x));
+    return rcpp_result_gen;
+END_RCPP
+}
+// psi_dtw_stream_state_cpp
+NumericVector psi_dtw_stream_state_cpp(SEXP stream);
+RcppExport SEXP _distantia_psi_dtw_stream_state_cpp(SEXP streamSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type stream(streamSEXP);
+    rcpp_result_gen = Rcpp::wrap(psi_dtw_stream_state_cpp(stream));
+    return rcpp_result_gen;
+END_RCPP
+}
+// psi_dtw_stream_save_cpp
+std::string psi_dtw_stream_save_cpp(SEXP stream, const std::string& file);
+RcppExport SEXP _distantia_psi_dtw_stream_save_cpp(SEXP streamSEXP, SEXP fileSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type stream(streamSEXP);
+    Rcpp::traits::input_parameter< const std::string& >::type file(fileSEXP);
+    rcpp_result_gen = Rcpp::wrap(psi_dtw_stream_save_cpp(stream, file));
+    return rcpp_result_gen;
+END_RCPP
+}
+// psi_dtw_stream_load_cpp
+SEXP psi_dtw_stream_load_cpp(const std::string& file);
+RcppExport SEXP _distantia_psi_dtw_stream_load_cpp(SEXP fileSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< const std::string& >::type file(fileSEXP);
+    rcpp_result_gen = Rcpp::wrap(psi_dtw_stream_load_cpp(file));
+    return rcpp_result_gen;
+END_RCPP
+}
+// psi_dtw_subsequence_cpp
+DataFrame psi_dtw_subsequence_cpp(NumericMatrix x, NumericMatrix y, int k, const std::string& distance, bool diagonal, bool weighted);
+RcppExport SEXP _distantia_psi_dtw_subsequence_cpp(SEXP xSEXP, SEXP ySEXP, SEXP kSEXP, SEXP distanceSEXP, SEXP diagonalSEXP, SEXP weightedSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< NumericMatrix >::type x(xSEXP);
+    Rcpp::traits::input_parameter< NumericMatrix >::type y(ySEXP);
+    Rcpp::traits::input_parameter< int >::type k(kSEXP);
+    Rcpp::traits::input_parameter< const std::string& >::type distance(distanceSEXP);
+    Rcpp::traits::input_parameter< bool >::type diagonal(diagonalSEXP);
+    Rcpp::traits::input_parameter< bool >::type weighted(weightedSEXP);
+    rcpp_result_gen = Rcpp::wrap(psi_dtw_subsequence_cpp(x, y, k, distance, diagonal, weighted));
+    return rcpp_result_gen;
+END_RCPP
+}
+// tsl_hash_cpp
+CharacterVector tsl_hash_cpp(List tsl);
+RcppExport SEXP _distantia_tsl_hash_cpp(SEXP tslSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< List >::type tsl(tslSEXP);
+    rcpp_result_gen = Rcpp::wrap(tsl_hash_cpp(tsl));
+    return rcpp_result_gen;
+END_RCPP
+}
+// tsl_prepare_cpp
+SEXP tsl_prepare_cpp(List tsl, Nullable<CharacterVector> distance, int threads);
+RcppExport SEXP _distantia_tsl_prepare_cpp(SEXP tslSEXP, SEXP distanceSEXP, SEXP threadsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< List >::type tsl(tslSEXP);
+    Rcpp::traits::input_parameter< Nullable<CharacterVector> >::type distance(distanceSEXP);
+    Rcpp::traits::input_parameter< int >::type threads(threadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(tsl_prepare_cpp(tsl, distance, threads));
+    return rcpp_result_gen;
+END_RCPP
+}
+// psi_dtw_tsl_cpp
+NumericVector psi_dtw_tsl_cpp(SEXP tsl, IntegerVector x, IntegerVector y, CharacterVector distance, LogicalVector diagonal, NumericVector bandwidth, bool weighted, bool ignore_blocks, int threads, double max_psi, Nullable<CharacterVector> step_pattern, const std::string& window, double window_size, double slope);
+RcppExport SEXP _distantia_psi_dtw_tsl_cpp(SEXP tslSEXP, SEXP xSEXP, SEXP ySEXP, SEXP distanceSEXP, SEXP diagonalSEXP, SEXP bandwidthSEXP, SEXP weightedSEXP, SEXP ignore_blocksSEXP, SEXP threadsSEXP, SEXP max_psiSEXP, SEXP step_patternSEXP, SEXP windowSEXP, SEXP window_sizeSEXP, SEXP slopeSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type tsl(tslSEXP);
+    Rcpp::traits::input_parameter< IntegerVector >::type x(xSEXP);
+    Rcpp::traits::input_parameter< IntegerVector >::type y(ySEXP);
+    Rcpp::traits::input_parameter< CharacterVector >::type distance(distanceSEXP);
+    Rcpp::traits::input_parameter< LogicalVector >::type diagonal(diagonalSEXP);
+    Rcpp::traits::input_parameter< NumericVector >::type bandwidth(bandwidthSEXP);
+    Rcpp::traits::input_parameter< bool >::type weighted(weightedSEXP);
+    Rcpp::traits::input_parameter< bool >::type ignore_blocks(ignore_blocksSEXP);
+    Rcpp::traits::input_parameter< int >::type threads(threadsSEXP);
+    Rcpp::traits::input_parameter< double >::type max_psi(max_psiSEXP);
+    Rcpp::traits::input_parameter< Nullable<CharacterVector> >::type step_pattern(step_patternSEXP);
+    Rcpp::traits::input_parameter< const std::string& >::type window(windowSEXP);
+    Rcpp::traits::input_parameter< double >::type window_size(window_sizeSEXP);
+    Rcpp::traits::input_parameter< double >::type slope(slopeSEXP);
+    rcpp_result_gen = Rcpp::wrap(psi_dtw_tsl_cpp(tsl, x, y, distance, diagonal, bandwidth, weighted, ignore_blocks, threads, max_psi, step_pattern, window, window_size, slope));
+    return rcpp_result_gen;
+END_RCPP
+}
+// psi_ls_tsl_cpp
+NumericVector psi_ls_tsl_cpp(SEXP tsl, IntegerVector x, IntegerVector y, CharacterVector distance, int threads);
+RcppExport SEXP _distantia_psi_ls_tsl_cpp(SEXP tslSEXP, SEXP xSEXP, SEXP ySEXP, SEXP distanceSEXP, SEXP threadsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type tsl(tslSEXP);
+    Rcpp::traits::input_parameter< IntegerVector >::type x(xSEXP);
+    Rcpp::traits::input_parameter< IntegerVector >::type y(ySEXP);
+    Rcpp::traits::input_parameter< CharacterVector >::type distance(distanceSEXP);
+    Rcpp::traits::input_parameter< int >::type threads(threadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(psi_ls_tsl_cpp(tsl, x, y, distance, threads));
+    return rcpp_result_gen;
+END_RCPP
+}
+// time_delay_cpp
+NumericVector time_delay_cpp(NumericMatrix x, NumericMatrix y, NumericVector x_time, NumericVector y_time, const std::string& distance, const std::string& method, double bandwidth, bool directional);
+RcppExport SEXP _distantia_time_delay_cpp(SEXP xSEXP, SEXP ySEXP, SEXP x_timeSEXP, SEXP y_timeSEXP, SEXP distanceSEXP, SEXP methodSEXP, SEXP bandwidthSEXP, SEXP directionalSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< NumericMatrix >::type x(xSEXP);
+    Rcpp::traits::input_parameter< NumericMatrix >::type y(ySEXP);
+    Rcpp::traits::input_parameter< NumericVector >::type x_time(x_timeSEXP);
+    Rcpp::traits::input_parameter< NumericVector >::type y_time(y_timeSEXP);
+    Rcpp::traits::input_parameter< const std::string& >::type distance(distanceSEXP);
+    Rcpp::traits::input_parameter< const std::string& >::type method(methodSEXP);
+    Rcpp::traits::input_parameter< double >::type bandwidth(bandwidthSEXP);
+    Rcpp::traits::input_parameter< bool >::type directional(directionalSEXP);
+    rcpp_result_gen = Rcpp::wrap(time_delay_cpp(x, y, x_time, y_time, distance, method, bandwidth, directional));
+    return rcpp_result_gen;
+END_RCPP
+}
+// time_delay_tsl_cpp
+NumericMatrix time_delay_tsl_cpp(SEXP tsl, List time, IntegerVector x, IntegerVector y, LogicalVector samples, const std::string& distance, const std::string& method, double bandwidth, bool directional, int threads);
+RcppExport SEXP _distantia_time_delay_tsl_cpp(SEXP tslSEXP, SEXP timeSEXP, SEXP xSEXP, SEXP ySEXP, SEXP samplesSEXP, SEXP distanceSEXP, SEXP methodSEXP, SEXP bandwidthSEXP, SEXP directionalSEXP, SEXP threadsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type tsl(tslSEXP);
+    Rcpp::traits::input_parameter< List >::type time(timeSEXP);
+    Rcpp::traits::input_parameter< IntegerVector >::type x(xSEXP);
+    Rcpp::traits::input_parameter< IntegerVector >::type y(ySEXP);
+    Rcpp::traits::input_parameter< LogicalVector >::type samples(samplesSEXP);
+    Rcpp::traits::input_parameter< const std::string& >::type distance(distanceSEXP);
+    Rcpp::traits::input_parameter< const std::string& >::type method(methodSEXP);
+    Rcpp::traits::input_parameter< double >::type bandwidth(bandwidthSEXP);
+    Rcpp::traits::input_parameter< bool >::type directional(directionalSEXP);
+    Rcpp::traits::input_parameter< int >::type threads(threadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(time_delay_tsl_cpp(tsl, time, x, y, samples, distance, method, bandwidth, directional, threads));
+    return rcpp_result_gen;
+END_RCPP
+}
+// tsl_binary_write_cpp
+void tsl_binary_write_cpp(List tsl, List time, List colnames, CharacterVector names, CharacterVector time_class, CharacterVector time_zone, const std::string& file);
+RcppExport SEXP _distantia_tsl_binary_write_cpp(SEXP tslSEXP, SEXP timeSEXP, SEXP colnamesSEXP, SEXP namesSEXP, SEXP time_classSEXP, SEXP time_zoneSEXP, SEXP fileSEXP) {
+BEGIN_RCPP
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< List >::type tsl(tslSEXP);
+    Rcpp::traits::input_parameter< List >::type time(timeSEXP);
+    Rcpp::traits::input_parameter< List >::type colnames(colnamesSEXP);
+    Rcpp::traits::input_parameter< CharacterVector >::type names(namesSEXP);
+    Rcpp::traits::input_parameter< CharacterVector >::type time_class(time_classSEXP);
+    Rcpp::traits::input_parameter< CharacterVector >::type time_zone(time_zoneSEXP);
+    Rcpp::traits::input_parameter< const std::string& >::type file(fileSEXP);
+    tsl_binary_write_cpp(tsl, time, colnames, names, time_class, time_zone, file);
+    return R_NilValue;
+END_RCPP
+}
+// tsl_binary_map_cpp
+SEXP tsl_binary_map_cpp(const std::string& file);
+RcppExport SEXP _distantia_tsl_binary_map_cpp(SEXP fileSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< const std::string& >::type file(fileSEXP);
+    rcpp_result_gen = Rcpp::wrap(tsl_binary_map_cpp(file));
+    return rcpp_result_gen;
+END_RCPP
+}
+// tsl_binary_info_cpp
+DataFrame tsl_binary_info_cpp(const std::string& file);
+RcppExport SEXP _distantia_tsl_binary_info_cpp(SEXP fileSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< const std::string& >::type file(fileSEXP);
+    rcpp_result_gen = Rcpp::wrap(tsl_binary_info_cpp(file));
+    return rcpp_result_gen;
+END_RCPP
+}
+// tsl_binary_read_cpp
+List tsl_binary_read_cpp(const std::string& file, Nullable<CharacterVector> names);
+RcppExport SEXP _distantia_tsl_binary_read_cpp(SEXP fileSEXP, SEXP namesSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< const std::string& >::type file(fileSEXP);
+    Rcpp::traits::input_parameter< Nullable<CharacterVector> >::type names(namesSEXP);
+    rcpp_result_gen = Rcpp::wrap(tsl_binary_read_cpp(file, names));
     return rcpp_result_gen;
 END_RCPP
 }
 
 static const R_CallMethodDef CallEntries[] = {
+    {"_distantia_alignment_cpp", (DL_FUNC) &_distantia_alignment_cpp, 7},
+    {"_distantia_alignment_sum_cpp", (DL_FUNC) &_distantia_alignment_sum_cpp, 1},
+    {"_distantia_alignment_trim_cpp", (DL_FUNC) &_distantia_alignment_trim_cpp, 1},
+    {"_distantia_alignment_auto_sum_cpp", (DL_FUNC) &_distantia_alignment_auto_sum_cpp, 5},
+    {"_distantia_alignment_update_dist_cpp", (DL_FUNC) &_distantia_alignment_update_dist_cpp, 4},
+    {"_distantia_alignment_df_cpp", (DL_FUNC) &_distantia_alignment_df_cpp, 1},
+    {"_distantia_alignment_cache_cpp", (DL_FUNC) &_distantia_alignment_cache_cpp, 2},
     {"_distantia_auto_distance_cpp", (DL_FUNC) &_distantia_auto_distance_cpp, 2},
     {"_distantia_subset_matrix_by_rows_cpp", (DL_FUNC) &_distantia_subset_matrix_by_rows_cpp, 2},
     {"_distantia_auto_sum_full_cpp", (DL_FUNC) &_distantia_auto_sum_full_cpp, 3},
@@ -615,7 +1028,7 @@ static const R_CallMethodDef CallEntries[] = {
     {"_distantia_cost_path_diagonal_cpp", (DL_FUNC) &_distantia_cost_path_diagonal_cpp, 2},
     {"_distantia_cost_path_trim_cpp", (DL_FUNC) &_distantia_cost_path_trim_cpp, 1},
     {"_distantia_cost_path_sum_cpp", (DL_FUNC) &_distantia_cost_path_sum_cpp, 1},
-    {"_distantia_cost_path_cpp", (DL_FUNC) &_distantia_cost_path_cpp, 7},
+    {"_distantia_cost_path_cpp", (DL_FUNC) &_distantia_cost_path_cpp, 13},
     {"_distantia_distance_matrix_cpp", (DL_FUNC) &_distantia_distance_matrix_cpp, 3},
     {"_distantia_distance_ls_cpp", (DL_FUNC) &_distantia_distance_ls_cpp, 3},
     {"_distantia_distance_chebyshev_cpp", (DL_FUNC) &_distantia_distance_chebyshev_cpp, 2},
@@ -633,9 +1046,11 @@ static const R_CallMethodDef CallEntries[] = {
     {"_distantia_update_path_dist_cpp", (DL_FUNC) &_distantia_update_path_dist_cpp, 4},
     {"_distantia_select_column_cpp", (DL_FUNC) &_distantia_select_column_cpp, 2},
     {"_distantia_delete_column_cpp", (DL_FUNC) &_distantia_delete_column_cpp, 2},
-    {"_distantia_importance_ls_cpp", (DL_FUNC) &_distantia_importance_ls_cpp, 3},
-    {"_distantia_importance_dtw_legacy_cpp", (DL_FUNC) &_distantia_importance_dtw_legacy_cpp, 7},
-    {"_distantia_importance_dtw_cpp", (DL_FUNC) &_distantia_importance_dtw_cpp, 7},
+    {"_distantia_importance_ls_cpp", (DL_FUNC) &_distantia_importance_ls_cpp, 4},
+    {"_distantia_importance_dtw_legacy_cpp", (DL_FUNC) &_distantia_importance_dtw_legacy_cpp, 8},
+    {"_distantia_importance_dtw_cpp", (DL_FUNC) &_distantia_importance_dtw_cpp, 8},
+    {"_distantia_knn_pairs_cpp", (DL_FUNC) &_distantia_knn_pairs_cpp, 3},
+    {"_distantia_matrix_profile_cpp", (DL_FUNC) &_distantia_matrix_profile_cpp, 4},
     {"_distantia_permute_restricted_by_row_cpp", (DL_FUNC) &_distantia_permute_restricted_by_row_cpp, 3},
     {"_distantia_permute_free_by_row_cpp", (DL_FUNC) &_distantia_permute_free_by_row_cpp, 3},
     {"_distantia_permute_restricted_cpp", (DL_FUNC) &_distantia_permute_restricted_cpp, 3},
@@ -643,8 +1058,26 @@ static const R_CallMethodDef CallEntries[] = {
     {"_distantia_psi_equation_cpp", (DL_FUNC) &_distantia_psi_equation_cpp, 3},
     {"_distantia_psi_ls_cpp", (DL_FUNC) &_distantia_psi_ls_cpp, 3},
     {"_distantia_psi_null_ls_cpp", (DL_FUNC) &_distantia_psi_null_ls_cpp, 7},
-    {"_distantia_psi_dtw_cpp", (DL_FUNC) &_distantia_psi_dtw_cpp, 7},
-    {"_distantia_psi_null_dtw_cpp", (DL_FUNC) &_distantia_psi_null_dtw_cpp, 11},
+    {"_distantia_psi_dtw_cpp", (DL_FUNC) &_distantia_psi_dtw_cpp, 13},
+    {"_distantia_psi_null_dtw_cpp", (DL_FUNC) &_distantia_psi_null_dtw_cpp, 17},
+    {"_distantia_psi_dtw_knn_cpp", (DL_FUNC) &_distantia_psi_dtw_knn_cpp, 9},
+    {"_distantia_psi_profile_cpp", (DL_FUNC) &_distantia_psi_profile_cpp, 11},
+    {"_distantia_psi_dtw_stream_cpp", (DL_FUNC) &_distantia_psi_dtw_stream_cpp, 4},
+    {"_distantia_psi_dtw_stream_append_cpp", (DL_FUNC) &_distantia_psi_dtw_stream_append_cpp, 2},
+    {"_distantia_psi_dtw_stream_state_cpp", (DL_FUNC) &_distantia_psi_dtw_stream_state_cpp, 1},
+    {"_distantia_psi_dtw_stream_save_cpp", (DL_FUNC) &_distantia_psi_dtw_stream_save_cpp, 2},
+    {"_distantia_psi_dtw_stream_load_cpp", (DL_FUNC) &_distantia_psi_dtw_stream_load_cpp, 1},
+    {"_distantia_psi_dtw_subsequence_cpp", (DL_FUNC) &_distantia_psi_dtw_subsequence_cpp, 6},
+    {"_distantia_tsl_hash_cpp", (DL_FUNC) &_distantia_tsl_hash_cpp, 1},
+    {"_distantia_tsl_prepare_cpp", (DL_FUNC) &_distantia_tsl_prepare_cpp, 3},
+    {"_distantia_psi_dtw_tsl_cpp", (DL_FUNC) &_distantia_psi_dtw_tsl_cpp, 14},
+    {"_distantia_psi_ls_tsl_cpp", (DL_FUNC) &_distantia_psi_ls_tsl_cpp, 5},
+    {"_distantia_time_delay_cpp", (DL_FUNC) &_distantia_time_delay_cpp, 8},
+    {"_distantia_time_delay_tsl_cpp", (DL_FUNC) &_distantia_time_delay_tsl_cpp, 10},
+    {"_distantia_tsl_binary_write_cpp", (DL_FUNC) &_distantia_tsl_binary_write_cpp, 7},
+    {"_distantia_tsl_binary_map_cpp", (DL_FUNC) &_distantia_tsl_binary_map_cpp, 1},
+    {"_distantia_tsl_binary_info_cpp", (DL_FUNC) &_distantia_tsl_binary_info_cpp, 1},
+    {"_distantia_tsl_binary_read_cpp", (DL_FUNC) &_distantia_tsl_binary_read_cpp, 2},
     {NULL, NULL, 0}
 };
 
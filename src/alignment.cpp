@@ -0,0 +1,515 @@
+#include <Rcpp.h>
+#include <cmath>
+#include "distance_methods.h"
+#include "distance_matrix.h"
+#include "cost_matrix.h"
+#include "cost_path_raw.h"
+#include "auto_sum.h"
+#include "alignment.h"
+#include "alignment_cache.h"
+using namespace Rcpp;
+
+// Internal function to get the alignment behind an external pointer returned
+// by alignment_cpp(), checking it is still valid.
+Alignment* alignment_get_cpp(
+    SEXP alignment,
+    const std::string& function_name
+){
+
+  if (TYPEOF(alignment) != EXTPTRSXP || !Rf_inherits(alignment, "cost_path_alignment")) {
+    Rcpp::stop("distantia::" + function_name + "(): argument 'alignment' must be the output of alignment_cpp().");
+  }
+
+  if (R_ExternalPtrAddr(alignment) == nullptr) {
+    Rcpp::stop("distantia::" + function_name + "(): the alignment is no longer valid (for example, after restoring a saved R session). Compute it again with alignment_cpp().");
+  }
+
+  XPtr<Alignment> ptr(alignment);
+
+  return ptr.get();
+
+}
+
+// Internal function to hand an alignment over to R as an external pointer
+// that deletes it when garbage collected.
+SEXP alignment_wrap_cpp(
+    Alignment* alignment
+){
+
+  XPtr<Alignment> ptr(alignment, true);
+  ptr.attr("class") = "cost_path_alignment";
+
+  return ptr;
+
+}
+
+// Internal function to compute the least cost path of two time series stored
+// as row-major buffers with the step pattern `pattern`, computing only the
+// cells of `window` (NULL for the full cost matrix, see cost_matrix_batch()).
+// With the step patterns "orthogonal", "symmetric1", and "weighted" and no
+// window, produces the same results as cost_path_cpp() with `diagonal` and
+// `weighted`. When the cache of least cost paths is enabled (see
+// alignment_cache_cpp()), paths are looked up there before computing them,
+// and stored afterwards. Returns false, with an empty path, when the last
+// cell of the cost matrix cannot be reached from the first one within the
+// window with the step pattern. Does not touch the R API.
+bool alignment_compute_cpp(
+    const double* x_rows,
+    int xn,
+    const double* y_rows,
+    int yn,
+    int cols,
+    DistanceFunctionRaw f,
+    StepPattern pattern,
+    const CostWindow* window,
+    bool ignore_blocks,
+    double bandwidth,
+    Alignment& alignment
+){
+
+  alignment.x_rows = xn;
+  alignment.y_rows = yn;
+
+  bool cached = alignment_cache_enabled();
+  AlignmentKey key;
+
+  if (cached) {
+
+    key = alignment_key_cpp(
+      alignment_hash_rows(x_rows, xn, cols),
+      xn,
+      alignment_hash_rows(y_rows, yn, cols),
+      yn,
+      cols,
+      f,
+      pattern,
+      window,
+      bandwidth
+    );
+
+    if (alignment_cache_get(key, alignment.path)) {
+
+      if (ignore_blocks) {
+        cost_path_trim_raw(alignment.path);
+      }
+
+      return true;
+
+    }
+
+  }
+
+  std::size_t cells = static_cast<std::size_t>(yn) * xn;
+  std::vector<double> dist_matrix(cells);
+  std::vector<double> cost_matrix(cells);
+
+  distance_matrix_raw(
+    x_rows,
+    xn,
+    y_rows,
+    yn,
+    cols,
+    f,
+    dist_matrix.data(),
+    1,
+    window
+  );
+
+  cost_matrix_batch(
+    dist_matrix.data(),
+    cost_matrix.data(),
+    yn,
+    xn,
+    1,
+    pattern,
+    window
+  );
+
+  if (std::isinf(cost_matrix[cells - 1])) {
+    alignment.path = CostPath();
+    return false;
+  }
+
+  cost_path_raw(
+    dist_matrix.data(),
+    cost_matrix.data(),
+    yn,
+    xn,
+    pattern,
+    bandwidth,
+    alignment.path
+  );
+
+  if (cached) {
+    alignment_cache_put(key, alignment.path);
+  }
+
+  if (ignore_blocks) {
+    cost_path_trim_raw(alignment.path);
+  }
+
+  return true;
+
+}
+
+// Internal function to compute the auto sum of two time series stored as
+// row-major buffers for an alignment (see auto_sum_cpp()). When
+// `ignore_blocks` is true, only the samples in the path are involved.
+// Does not touch the R API.
+double alignment_auto_sum_raw(
+    const Alignment& alignment,
+    const double* x_rows,
+    const double* y_rows,
+    int cols,
+    DistanceFunctionRaw f,
+    bool ignore_blocks
+){
+
+  std::vector<int> from;
+  std::vector<int> to;
+
+  auto_sum_pairs_cpp(alignment.x_rows, alignment.path.x, ignore_blocks, from, to);
+  double x_distance = auto_distance_rows_cpp(x_rows, cols, from, to, f);
+
+  auto_sum_pairs_cpp(alignment.y_rows, alignment.path.y, ignore_blocks, from, to);
+  double y_distance = auto_distance_rows_cpp(y_rows, cols, from, to, f);
+
+  // rounding to 8 decimal places
+  double factor = std::pow(10.0, 8);
+  return std::round((x_distance + y_distance) * factor) / factor;
+
+}
+
+// Internal function to check that two time series have the dimensions of
+// the ones an alignment was computed from.
+void alignment_check_series_cpp(
+    const Alignment& alignment,
+    NumericMatrix x,
+    NumericMatrix y,
+    const std::string& function_name
+){
+
+  if (x.nrow() != alignment.x_rows || y.nrow() != alignment.y_rows) {
+    Rcpp::stop("distantia::" + function_name + "(): the number of rows of 'x' and 'y' must match the ones of the time series used to compute 'alignment'.");
+  }
+
+  if (x.ncol() != y.ncol()) {
+    Rcpp::stop("distantia::" + function_name + "(): 'x' and 'y' must have the same number of columns.");
+  }
+
+}
+
+//' (C++) Least Cost Path Kept in C++
+//' @description Computes the least cost path between two time series, as
+//' [cost_path_cpp()], but keeps it in C++ with integer coordinates and
+//' returns an external pointer to it, with no intermediate R matrices or data
+//' frames. The functions [alignment_sum_cpp()], [alignment_trim_cpp()],
+//' [alignment_auto_sum_cpp()], and [alignment_update_dist_cpp()] work on the
+//' alignment directly, and [alignment_df_cpp()] converts it to the data frame
+//' returned by [cost_path_cpp()] when needed. External pointers do not
+//' survive saving and restoring an R session.
+//' @param x (required, numeric matrix) multivariate time series.
+//' @param y (required, numeric matrix) multivariate time series
+//' with the same number of columns as 'x'.
+//' @param distance (optional, character string) distance name from the "names"
+//' column of the dataset `distances` (see `distances$name`). Default: "euclidean".
+//' @param diagonal (optional, logical). If TRUE, diagonals are included in the
+//' computation of the cost matrix. Default: TRUE.
+//' @param weighted (optional, logical). Only relevant when diagonal is TRUE. When TRUE,
+//' diagonal cost is weighted by y factor of 1.414214 (square root of 2). Default: TRUE.
+//' @param ignore_blocks (optional, logical). If TRUE, blocks of consecutive path
+//' coordinates are trimmed to avoid inflating the psi distance. Default: FALSE.
+//' @param bandwidth (required, numeric) Size of the Sakoe-Chiba band at
+//' both sides of the diagonal used to constrain the least cost path. Expressed
+//' as a fraction of the number of matrix rows and columns. Unrestricted by default.
+//' Default: 1
+//' @return external pointer of class "cost_path_alignment".
+//' @examples
+//' #simulate two time series
+//' x <- zoo_simulate(seed = 1)
+//' y <- zoo_simulate(seed = 2)
+//'
+//' #least cost path
+//' alignment <- alignment_cpp(
+//'   x = x,
+//'   y = y,
+//'   distance = "euclidean"
+//' )
+//'
+//' #psi score
+//' psi_equation_cpp(
+//'   a = alignment_sum_cpp(alignment),
+//'   b = alignment_auto_sum_cpp(alignment, x = x, y = y),
+//'   diagonal = TRUE
+//' )
+//'
+//' #as data frame
+//' head(alignment_df_cpp(alignment))
+//' @export
+//' @family Rcpp_cost_path
+// [[Rcpp::export]]
+SEXP alignment_cpp(
+    NumericMatrix x,
+    NumericMatrix y,
+    const std::string& distance = "euclidean",
+    bool diagonal = true,
+    bool weighted = true,
+    bool ignore_blocks = false,
+    double bandwidth = 1
+){
+
+  if (x.ncol() != y.ncol()) {
+    Rcpp::stop("distantia::alignment_cpp(): 'x' and 'y' must have the same number of columns.");
+  }
+
+  DistanceFunctionRaw f = select_distance_function_raw(distance);
+
+  std::vector<double> x_rows = matrix_rows_cpp(x);
+  std::vector<double> y_rows = matrix_rows_cpp(y);
+
+  Alignment* alignment = new Alignment();
+
+  alignment_compute_cpp(
+    x_rows.data(),
+    x.nrow(),
+    y_rows.data(),
+    y.nrow(),
+    x.ncol(),
+    f,
+    cost_matrix_step_pattern(diagonal, weighted),
+    NULL,
+    ignore_blocks,
+    bandwidth,
+    *alignment
+  );
+
+  return alignment_wrap_cpp(alignment);
+
+}
+
+//' (C++) Sum Distances in a Least Cost Path Kept in C++
+//' @description Same as [cost_path_sum_cpp()] for the output of [alignment_cpp()].
+//' @param alignment (required, external pointer) output of [alignment_cpp()].
+//' @return numeric
+//' @examples
+//' x <- zoo_simulate(seed = 1)
+//' y <- zoo_simulate(seed = 2)
+//'
+//' alignment <- alignment_cpp(
+//'   x = x,
+//'   y = y
+//' )
+//'
+//' alignment_sum_cpp(alignment)
+//' @export
+//' @family Rcpp_cost_path
+// [[Rcpp::export]]
+double alignment_sum_cpp(
+    SEXP alignment
+){
+
+  return cost_path_sum_raw(
+    alignment_get_cpp(alignment, "alignment_sum_cpp")->path
+  );
+
+}
+
+//' (C++) Remove Blocks from a Least Cost Path Kept in C++
+//' @description Same as [cost_path_trim_cpp()] for the output of
+//' [alignment_cpp()]. The input alignment is not modified.
+//' @param alignment (required, external pointer) output of [alignment_cpp()].
+//' @return external pointer of class "cost_path_alignment".
+//' @examples
+//' x <- zoo_simulate(seed = 1)
+//' y <- zoo_simulate(seed = 2)
+//'
+//' alignment <- alignment_cpp(
+//'   x = x,
+//'   y = y
+//' )
+//'
+//' alignment_trimmed <- alignment_trim_cpp(alignment)
+//'
+//' nrow(alignment_df_cpp(alignment))
+//' nrow(alignment_df_cpp(alignment_trimmed))
+//' @export
+//' @family Rcpp_cost_path
+// [[Rcpp::export]]
+SEXP alignment_trim_cpp(
+    SEXP alignment
+){
+
+  Alignment* trimmed = new Alignment(
+    *alignment_get_cpp(alignment, "alignment_trim_cpp")
+  );
+
+  cost_path_trim_raw(trimmed->path);
+
+  return alignment_wrap_cpp(trimmed);
+
+}
+
+//' (C++) Auto Sum of Two Time Series Aligned in C++
+//' @description Same as [auto_sum_cpp()] for the output of [alignment_cpp()].
+//' @param alignment (required, external pointer) output of [alignment_cpp()].
+//' @param x (required, numeric matrix) time series used to compute `alignment`.
+//' @param y (required, numeric matrix) time series used to compute `alignment`.
+//' @param distance (optional, character string) distance name from the "names"
+//' column of the dataset `distances` (see `distances$name`). Default: "euclidean".
+//' @param ignore_blocks (optional, logical). If TRUE, the auto sums only
+//' involve the samples in the least cost path, which should then be trimmed
+//' (see [alignment_trim_cpp()]). Default: FALSE.
+//' @return numeric
+//' @examples
+//' x <- zoo_simulate(seed = 1)
+//' y <- zoo_simulate(seed = 2)
+//'
+//' alignment <- alignment_cpp(
+//'   x = x,
+//'   y = y
+//' )
+//'
+//' alignment_auto_sum_cpp(
+//'   alignment = alignment,
+//'   x = x,
+//'   y = y
+//' )
+//' @export
+//' @family Rcpp_cost_path
+// [[Rcpp::export]]
+double alignment_auto_sum_cpp(
+    SEXP alignment,
+    NumericMatrix x,
+    NumericMatrix y,
+    const std::string& distance = "euclidean",
+    bool ignore_blocks = false
+){
+
+  Alignment* a = alignment_get_cpp(alignment, "alignment_auto_sum_cpp");
+  alignment_check_series_cpp(*a, x, y, "alignment_auto_sum_cpp");
+
+  DistanceFunctionRaw f = select_distance_function_raw(distance);
+
+  std::vector<double> x_rows = matrix_rows_cpp(x);
+  std::vector<double> y_rows = matrix_rows_cpp(y);
+
+  return alignment_auto_sum_raw(
+    *a,
+    x_rows.data(),
+    y_rows.data(),
+    x.ncol(),
+    f,
+    ignore_blocks
+  );
+
+}
+
+//' (C++) Update Distances in a Least Cost Path Kept in C++
+//' @description Recomputes the distances between the samples of two time
+//' series along the output of [alignment_cpp()], for example after changing
+//' the variables of the time series or the distance. The path coordinates
+//' are kept, and costs are set to zero. The input alignment is not modified.
+//' @param alignment (required, external pointer) output of [alignment_cpp()].
+//' @param x (required, numeric matrix) time series with the same number of
+//' rows as the one used to compute `alignment`.
+//' @param y (required, numeric matrix) time series with the same number of
+//' rows as the one used to compute `alignment`.
+//' @param distance (optional, character string) distance name from the "names"
+//' column of the dataset `distances` (see `distances$name`). Default: "euclidean".
+//' @return external pointer of class "cost_path_alignment".
+//' @examples
+//' x <- zoo_simulate(seed = 1)
+//' y <- zoo_simulate(seed = 2)
+//'
+//' alignment <- alignment_cpp(
+//'   x = x,
+//'   y = y
+//' )
+//'
+//' #sum of manhattan distances along the euclidean path
+//' alignment_update_dist_cpp(
+//'   alignment = alignment,
+//'   x = x,
+//'   y = y,
+//'   distance = "manhattan"
+//' ) |>
+//'   alignment_sum_cpp()
+//' @export
+//' @family Rcpp_cost_path
+// [[Rcpp::export]]
+SEXP alignment_update_dist_cpp(
+    SEXP alignment,
+    NumericMatrix x,
+    NumericMatrix y,
+    const std::string& distance = "euclidean"
+){
+
+  Alignment* a = alignment_get_cpp(alignment, "alignment_update_dist_cpp");
+  alignment_check_series_cpp(*a, x, y, "alignment_update_dist_cpp");
+
+  DistanceFunctionRaw f = select_distance_function_raw(distance);
+
+  std::vector<double> x_rows = matrix_rows_cpp(x);
+  std::vector<double> y_rows = matrix_rows_cpp(y);
+  int cols = x.ncol();
+
+  Alignment* updated = new Alignment(*a);
+
+  for (std::size_t i = 0; i < updated->path.x.size(); i++) {
+
+    updated->path.dist[i] = f(
+      y_rows.data() + static_cast<std::size_t>(updated->path.y[i]) * cols,
+      x_rows.data() + static_cast<std::size_t>(updated->path.x[i]) * cols,
+      cols
+    );
+
+    updated->path.cost[i] = 0;
+
+  }
+
+  return alignment_wrap_cpp(updated);
+
+}
+
+//' (C++) Convert a Least Cost Path Kept in C++ to a Data Frame
+//' @description Converts the output of [alignment_cpp()] to the data frame
+//' returned by [cost_path_cpp()], with 1-based integer coordinates.
+//' @param alignment (required, external pointer) output of [alignment_cpp()].
+//' @return data frame
+//' @examples
+//' x <- zoo_simulate(seed = 1)
+//' y <- zoo_simulate(seed = 2)
+//'
+//' alignment <- alignment_cpp(
+//'   x = x,
+//'   y = y
+//' )
+//'
+//' head(alignment_df_cpp(alignment))
+//' @export
+//' @family Rcpp_cost_path
+// [[Rcpp::export]]
+DataFrame alignment_df_cpp(
+    SEXP alignment
+){
+
+  const CostPath& path = alignment_get_cpp(alignment, "alignment_df_cpp")->path;
+
+  int n = path.x.size();
+
+  IntegerVector x(n);
+  IntegerVector y(n);
+
+  for (int i = 0; i < n; i++) {
+    x[i] = path.x[i] + 1;
+    y[i] = path.y[i] + 1;
+  }
+
+  return DataFrame::create(
+    _["x"] = x,
+    _["y"] = y,
+    _["dist"] = NumericVector(path.dist.begin(), path.dist.end()),
+    _["cost"] = NumericVector(path.cost.begin(), path.cost.end())
+  );
+
+}
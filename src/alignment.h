@@ -0,0 +1,49 @@
+#ifndef ALIGNMENT_H
+#define ALIGNMENT_H
+
+#include <Rcpp.h>
+#include "distance_methods.h"
+#include "cost_path_raw.h"
+
+// Least cost path between two time series kept in C++ as an external pointer
+// (see alignment_cpp()), with the number of rows of the time series it was
+// computed from, used to validate later calls.
+struct Alignment {
+  CostPath path;
+  int x_rows;
+  int y_rows;
+};
+
+Alignment* alignment_get_cpp(
+    SEXP alignment,
+    const std::string& function_name
+);
+
+SEXP alignment_wrap_cpp(
+    Alignment* alignment
+);
+
+bool alignment_compute_cpp(
+    const double* x_rows,
+    int xn,
+    const double* y_rows,
+    int yn,
+    int cols,
+    DistanceFunctionRaw f,
+    StepPattern pattern,
+    const CostWindow* window,
+    bool ignore_blocks,
+    double bandwidth,
+    Alignment& alignment
+);
+
+double alignment_auto_sum_raw(
+    const Alignment& alignment,
+    const double* x_rows,
+    const double* y_rows,
+    int cols,
+    DistanceFunctionRaw f,
+    bool ignore_blocks
+);
+
+#endif // ALIGNMENT_H
@@ -0,0 +1,280 @@
+#include <Rcpp.h>
+#include <cstring>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include "alignment_cache.h"
+using namespace Rcpp;
+
+// Session-level cache of least cost paths shared by all functions computing
+// alignments (see alignment_cache_cpp()). Entries are kept in order of use,
+// most recent first, and the least recently used ones are evicted when the
+// memory used by the paths exceeds `max_bytes`. Disabled when `max_bytes` is
+// zero. Access is serialized by a mutex, because engines look up paths from
+// their worker threads.
+namespace {
+
+struct AlignmentKeyHash {
+  std::size_t operator()(const AlignmentKey& key) const {
+    std::uint64_t h = key.x_hash * 1099511628211ULL;
+    h ^= key.y_hash + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2);
+    h ^= key.window_hash + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2);
+    h ^= static_cast<std::uint64_t>(key.pattern);
+    return static_cast<std::size_t>(h);
+  }
+};
+
+struct AlignmentCacheEntry {
+  AlignmentKey key;
+  CostPath path;
+  std::size_t bytes;
+};
+
+struct AlignmentCache {
+  std::mutex mutex;
+  std::list<AlignmentCacheEntry> entries;
+  std::unordered_map<AlignmentKey, std::list<AlignmentCacheEntry>::iterator, AlignmentKeyHash> index;
+  std::size_t max_bytes = 0;
+  std::size_t bytes = 0;
+  double hits = 0;
+  double misses = 0;
+};
+
+AlignmentCache& alignment_cache(){
+  static AlignmentCache cache;
+  return cache;
+}
+
+std::size_t path_bytes(const CostPath& path){
+  return sizeof(AlignmentCacheEntry) +
+    path.x.size() * (2 * sizeof(int) + 2 * sizeof(double));
+}
+
+// Removes least recently used entries until the cache fits in its budget.
+// Requires the mutex.
+void alignment_cache_shrink(AlignmentCache& cache){
+  while (cache.bytes > cache.max_bytes && !cache.entries.empty()) {
+    cache.bytes -= cache.entries.back().bytes;
+    cache.index.erase(cache.entries.back().key);
+    cache.entries.pop_back();
+  }
+}
+
+}
+
+// Internal function to hash the content of a time series stored as a
+// row-major buffer (64-bit FNV-1a over its dimensions and values).
+std::uint64_t alignment_hash_rows(
+    const double* rows,
+    int nrow,
+    int ncol
+){
+
+  std::uint64_t h = 14695981039346656037ULL;
+
+  auto mix = [&h](const void* data, std::size_t size) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    for (std::size_t i = 0; i < size; ++i) {
+      h ^= bytes[i];
+      h *= 1099511628211ULL;
+    }
+  };
+
+  mix(&nrow, sizeof(int));
+  mix(&ncol, sizeof(int));
+  mix(rows, static_cast<std::size_t>(nrow) * ncol * sizeof(double));
+
+  return h;
+
+}
+
+// Internal function to check whether the cache is enabled.
+bool alignment_cache_enabled(){
+  AlignmentCache& cache = alignment_cache();
+  std::lock_guard<std::mutex> lock(cache.mutex);
+  return cache.max_bytes > 0;
+}
+
+// Internal function to build the key of a least cost path. Windows are
+// identified by a hash of their cells (FNV-1a), and the full cost matrix
+// (`window` NULL) by zero.
+AlignmentKey alignment_key_cpp(
+    std::uint64_t x_hash,
+    int x_rows,
+    std::uint64_t y_hash,
+    int y_rows,
+    int cols,
+    DistanceFunctionRaw f,
+    StepPattern pattern,
+    const CostWindow* window,
+    double bandwidth
+){
+
+  AlignmentKey key;
+  key.x_hash = x_hash;
+  key.y_hash = y_hash;
+  key.x_rows = x_rows;
+  key.y_rows = y_rows;
+  key.cols = cols;
+  key.f = f;
+  key.pattern = static_cast<int>(pattern);
+  key.window_hash = 0;
+  key.bandwidth = bandwidth;
+
+  if (window != NULL) {
+
+    std::uint64_t h = 14695981039346656037ULL;
+
+    auto mix = [&h](const std::vector<int>& v) {
+      const unsigned char* bytes = reinterpret_cast<const unsigned char*>(v.data());
+      for (std::size_t i = 0; i < v.size() * sizeof(int); ++i) {
+        h ^= bytes[i];
+        h *= 1099511628211ULL;
+      }
+    };
+
+    mix(window->lo);
+    mix(window->hi);
+
+    key.window_hash = h == 0 ? 1 : h;
+
+  }
+
+  return key;
+
+}
+
+// Internal function to copy a cached least cost path into `path`. Returns
+// false when the path is not in the cache.
+bool alignment_cache_get(
+    const AlignmentKey& key,
+    CostPath& path
+){
+
+  AlignmentCache& cache = alignment_cache();
+  std::lock_guard<std::mutex> lock(cache.mutex);
+
+  auto it = cache.index.find(key);
+
+  if (it == cache.index.end()) {
+    cache.misses += 1;
+    return false;
+  }
+
+  //most recently used first
+  cache.entries.splice(cache.entries.begin(), cache.entries, it->second);
+  path = it->second->path;
+  cache.hits += 1;
+
+  return true;
+
+}
+
+// Internal function to store a least cost path in the cache.
+void alignment_cache_put(
+    const AlignmentKey& key,
+    const CostPath& path
+){
+
+  AlignmentCache& cache = alignment_cache();
+  std::lock_guard<std::mutex> lock(cache.mutex);
+
+  std::size_t bytes = path_bytes(path);
+
+  if (cache.max_bytes == 0 || bytes > cache.max_bytes || cache.index.count(key)) {
+    return;
+  }
+
+  cache.entries.push_front(AlignmentCacheEntry{key, path, bytes});
+  cache.index[key] = cache.entries.begin();
+  cache.bytes += bytes;
+
+  alignment_cache_shrink(cache);
+
+}
+
+//' (C++) Cache of Least Cost Paths
+//' @description Controls an opt-in cache of least cost paths shared by all
+//' functions computing dynamic time warping alignments in the current R
+//' session, such as [distantia()], [momentum()], [distantia_time_delay()],
+//' and [psi_dtw_cpp()]. Paths are identified by the content of the time
+//' series, the distance, and the arguments `diagonal`, `weighted`, and
+//' `bandwidth`, so analyses repeated on the same data and parameters reuse
+//' the paths computed by earlier ones instead of aligning the time series
+//' again. When the memory used by the cached paths exceeds `max_mb`, the
+//' least recently used ones are discarded. The cache is disabled by default.
+//' @param max_mb (optional, numeric) maximum size of the cache in megabytes.
+//' Zero disables the cache and discards its content. If NULL, the current
+//' setting is kept. Default: NULL
+//' @param clear (optional, logical) if TRUE, cached paths are discarded.
+//' Default: FALSE
+//' @return named numeric vector with the maximum size of the cache
+//' (`max_mb`), its current size (`mb`), the number of cached paths
+//' (`paths`), and the number of lookups that found (`hits`) or did not find
+//' (`misses`) a path since the cache was enabled.
+//' @examples
+//' #enable the cache
+//' alignment_cache_cpp(max_mb = 64)
+//'
+//' tsl <- tsl_simulate(
+//'   n = 3,
+//'   seed = 1
+//' )
+//'
+//' #paths are computed and cached
+//' df <- distantia_dtw(tsl = tsl)
+//'
+//' #paths are reused
+//' df <- distantia_dtw(tsl = tsl)
+//'
+//' alignment_cache_cpp()
+//'
+//' #disable the cache
+//' alignment_cache_cpp(max_mb = 0)
+//' @export
+//' @family Rcpp_cost_path
+// [[Rcpp::export]]
+NumericVector alignment_cache_cpp(
+    Nullable<NumericVector> max_mb = R_NilValue,
+    bool clear = false
+){
+
+  AlignmentCache& cache = alignment_cache();
+  std::lock_guard<std::mutex> lock(cache.mutex);
+
+  double mb = 1024.0 * 1024.0;
+
+  if (max_mb.isNotNull()) {
+
+    NumericVector max_mb_value(max_mb.get());
+
+    if (max_mb_value.size() != 1 || ISNAN(max_mb_value[0]) || max_mb_value[0] < 0) {
+      Rcpp::stop("distantia::alignment_cache_cpp(): argument 'max_mb' must be a single non-negative number.");
+    }
+
+    if (cache.max_bytes == 0) {
+      cache.hits = 0;
+      cache.misses = 0;
+    }
+
+    cache.max_bytes = static_cast<std::size_t>(max_mb_value[0] * mb);
+
+  }
+
+  if (clear) {
+    cache.entries.clear();
+    cache.index.clear();
+    cache.bytes = 0;
+  }
+
+  alignment_cache_shrink(cache);
+
+  return NumericVector::create(
+    _["max_mb"] = cache.max_bytes / mb,
+    _["mb"] = cache.bytes / mb,
+    _["paths"] = static_cast<double>(cache.entries.size()),
+    _["hits"] = cache.hits,
+    _["misses"] = cache.misses
+  );
+
+}
@@ -0,0 +1,62 @@
+#ifndef ALIGNMENT_CACHE_H
+#define ALIGNMENT_CACHE_H
+
+#include <cstdint>
+#include "distance_methods.h"
+#include "cost_matrix.h"
+#include "cost_path_raw.h"
+
+// Identity of a least cost path: content of the time series and parameters
+// of the alignment. Paths are stored before removing blocks, so the same
+// entry serves `ignore_blocks = TRUE` and `FALSE`.
+struct AlignmentKey {
+  std::uint64_t x_hash;
+  std::uint64_t y_hash;
+  int x_rows;
+  int y_rows;
+  int cols;
+  DistanceFunctionRaw f;
+  int pattern;
+  std::uint64_t window_hash;
+  double bandwidth;
+
+  bool operator==(const AlignmentKey& other) const {
+    return x_hash == other.x_hash && y_hash == other.y_hash &&
+      x_rows == other.x_rows && y_rows == other.y_rows &&
+      cols == other.cols && f == other.f &&
+      pattern == other.pattern && window_hash == other.window_hash &&
+      bandwidth == other.bandwidth;
+  }
+};
+
+std::uint64_t alignment_hash_rows(
+    const double* rows,
+    int nrow,
+    int ncol
+);
+
+bool alignment_cache_enabled();
+
+AlignmentKey alignment_key_cpp(
+    std::uint64_t x_hash,
+    int x_rows,
+    std::uint64_t y_hash,
+    int y_rows,
+    int cols,
+    DistanceFunctionRaw f,
+    StepPattern pattern,
+    const CostWindow* window,
+    double bandwidth
+);
+
+bool alignment_cache_get(
+    const AlignmentKey& key,
+    CostPath& path
+);
+
+void alignment_cache_put(
+    const AlignmentKey& key,
+    const CostPath& path
+);
+
+#endif // ALIGNMENT_CACHE_H
@@ -1,6 +1,7 @@
 #include <Rcpp.h>
 #include <cmath>
 #include "distance_methods.h"
+#include "column_view.h"
 using namespace Rcpp;
 
 //' (C++) Sum Distances Between Consecutive Samples in a Time Series
@@ -43,6 +44,103 @@ double auto_distance_cpp(
 
 }
 
+// Internal function to list the pairs of consecutive rows used to compute
+// auto sums: all rows of the time series, or its unique rows in a least-cost
+// path when blocks are ignored (see auto_sum_cpp()). `path_rows` holds the
+// 0-based path coordinates, and is ignored when `ignore_blocks` is false.
+void auto_sum_pairs_cpp(
+    int rows,
+    const std::vector<int>& path_rows,
+    bool ignore_blocks,
+    std::vector<int>& from,
+    std::vector<int>& to
+){
+
+  std::vector<int> sequence;
+
+  if (ignore_blocks) {
+
+    std::unordered_set<int> seen;
+
+    for (int row : path_rows) {
+      if (seen.insert(row).second) {
+        sequence.push_back(row);
+      }
+    }
+
+  } else {
+
+    for (int i = 0; i < rows; ++i) {
+      sequence.push_back(i);
+    }
+
+  }
+
+  from.clear();
+  to.clear();
+
+  for (int i = 0; i < static_cast<int>(sequence.size()) - 1; ++i) {
+    from.push_back(sequence[i]);
+    to.push_back(sequence[i + 1]);
+  }
+
+}
+
+// Internal function to sum the distances between the pairs of rows `from`
+// and `to` of a column view (see auto_distance_cpp()). Rows are gathered
+// into small buffers, so the matrix behind the view is never copied.
+double auto_distance_view_cpp(
+    const ColumnView& x,
+    const std::vector<int>& from,
+    const std::vector<int>& to,
+    DistanceFunctionRaw f
+){
+
+  int cols = x.ncol();
+
+  std::vector<double> a(cols);
+  std::vector<double> b(cols);
+
+  double dist = 0.0;
+
+  for (std::size_t i = 0; i < from.size(); i++) {
+    x.row(from[i], a.data());
+    x.row(to[i], b.data());
+    dist += f(a.data(), b.data(), cols);
+  }
+
+  // rounding to 8 decimal places
+  double factor = std::pow(10.0, 8);
+  return std::round(dist * factor) / factor;
+
+}
+
+// Internal function to sum the distances between the pairs of rows `from`
+// and `to` of a row-major buffer with `cols` columns (see auto_distance_cpp()).
+double auto_distance_rows_cpp(
+    const double* rows,
+    int cols,
+    const std::vector<int>& from,
+    const std::vector<int>& to,
+    DistanceFunctionRaw f
+){
+
+  double dist = 0.0;
+
+  for (std::size_t i = 0; i < from.size(); i++) {
+    dist += f(
+      rows + static_cast<std::size_t>(from[i]) * cols,
+      rows + static_cast<std::size_t>(to[i]) * cols,
+      cols
+    );
+  }
+
+  // rounding to 8 decimal places
+  double factor = std::pow(10.0, 8);
+  return std::round(dist * factor) / factor;
+
+}
+
 //' (C++) Subset Matrix by Rows
 //' @description Subsets a time series matrix to the coordinates of a trimmed
 //' least-cost path when blocks are ignored during a dissimilarity analysis.
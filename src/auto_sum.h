@@ -2,6 +2,8 @@
 #define AUTO_SUM_H
 
 #include <Rcpp.h>
+#include "distance_methods.h"
+#include "column_view.h"
 
 // Distance matrix function declaration
 double auto_distance_cpp(
@@ -37,4 +39,27 @@ double auto_sum_cpp(
         bool ignore_blocks = false
 );
 
+void auto_sum_pairs_cpp(
+    int rows,
+    const std::vector<int>& path_rows,
+    bool ignore_blocks,
+    std::vector<int>& from,
+    std::vector<int>& to
+);
+
+double auto_distance_view_cpp(
+    const ColumnView& x,
+    const std::vector<int>& from,
+    const std::vector<int>& to,
+    DistanceFunctionRaw f
+);
+
+double auto_distance_rows_cpp(
+    const double* rows,
+    int cols,
+    const std::vector<int>& from,
+    const std::vector<int>& to,
+    DistanceFunctionRaw f
+);
+
 #endif // AUTO_SUM_H
@@ -0,0 +1,88 @@
+#ifndef COLUMN_VIEW_H
+#define COLUMN_VIEW_H
+
+#include <Rcpp.h>
+#include <vector>
+
+// Read-only view of a subset of the columns of a numeric matrix.
+// Values are read from the memory of the matrix, so subsets of variables
+// used to compute importance scores do not require copies of the time series.
+// The matrix must outlive the view. Does not touch the R API once created.
+struct ColumnView {
+
+  const double* data;
+  int nrow;
+  std::vector<int> columns;
+
+  int ncol() const {
+    return static_cast<int>(columns.size());
+  }
+
+  // Copies the selected columns of row `i` into `out`
+  void row(int i, double* out) const {
+    for (std::size_t k = 0; k < columns.size(); ++k) {
+      out[k] = data[i + static_cast<std::size_t>(columns[k]) * nrow];
+    }
+  }
+
+};
+
+// View of the column `column_index` of a column-major matrix with `nrow`
+// rows and `ncol` columns stored in `data` (only_with = true), or of all its
+// other columns (only_with = false). Safe to call outside of the main thread.
+inline ColumnView column_view_cpp(
+    const double* data,
+    int nrow,
+    int ncol,
+    int column_index,
+    bool only_with
+){
+
+  ColumnView view;
+  view.data = data;
+  view.nrow = nrow;
+
+  for (int k = 0; k < ncol; ++k) {
+    if ((k == column_index) == only_with) {
+      view.columns.push_back(k);
+    }
+  }
+
+  return view;
+
+}
+
+// View of the column `column_index` of `m` alone (only_with = true),
+// or of all other columns of `m` (only_with = false).
+inline ColumnView column_view_cpp(
+    const Rcpp::NumericMatrix& m,
+    int column_index,
+    bool only_with
+){
+
+  return column_view_cpp(
+    m.begin(),
+    m.nrow(),
+    m.ncol(),
+    column_index,
+    only_with
+  );
+
+}
+
+// View of all columns of `m`
+inline ColumnView column_view_all_cpp(
+    const Rcpp::NumericMatrix& m
+){
+
+  return column_view_cpp(
+    m.begin(),
+    m.nrow(),
+    m.ncol(),
+    -1,
+    false
+  );
+
+}
+
+#endif // COLUMN_VIEW_H
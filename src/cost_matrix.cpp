@@ -1,4 +1,5 @@
 #include <Rcpp.h>
+#include "cost_matrix.h"
 using namespace Rcpp;
 
 //' (C++) Compute Orthogonal and Diagonal Least Cost Matrix from a Distance Matrix
@@ -127,6 +128,48 @@ NumericMatrix cost_matrix_orthogonal_cpp(
  }
 
 
+// Internal function to compute the least cost matrices of several problems
+// with the same shape at once. `dist_matrix` and `cost_matrix` hold `lanes`
+// interleaved matrices in which the values of cell (i, j) for all problems are
+// contiguous (see distance_matrix_raw()). The recurrence advances all problems
+// in lockstep, and the compiler turns the inner loops over problems into
+// vector min/add instructions. With the step patterns "orthogonal",
+// "symmetric1", and "weighted", produces the same values as
+// cost_matrix_orthogonal_cpp(), cost_matrix_diagonal_cpp(), and
+// cost_matrix_diagonal_weighted_cpp(). When `window` is not NULL, only its
+// cells are computed, and the others have infinite cost. Does not touch the
+// R API.
+void cost_matrix_batch(
+    const double* dist_matrix,
+    double* cost_matrix,
+    int yn,
+    int xn,
+    int lanes,
+    StepPattern pattern,
+    const CostWindow* window
+){
+
+  std::size_t col = static_cast<std::size_t>(yn) * lanes;
+
+  // Column by column, so cells of consecutive rows are contiguous
+  for (int j = 0; j < xn; ++j) {
+    cost_matrix_column(
+      dist_matrix + j * col,
+      j == 0 ? NULL : cost_matrix + (j - 1) * col,
+      cost_matrix + j * col,
+      yn,
+      lanes,
+      pattern,
+      window == NULL ? 0 : window->lo[j],
+      window == NULL ? yn - 1 : window->hi[j]
+    );
+  }
+
+  // Adjusting the last cell to include the return cost to the starting point
+  cost_matrix_return(cost_matrix, yn, xn, lanes);
+
+}
+
 // You can include R code blocks in C++ files processed with sourceCpp
 // (useful for testing and development). The R code will be automatically
 // run after the compilation.
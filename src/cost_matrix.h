@@ -2,9 +2,333 @@
 #define COST_MATRIX_H
 
 #include <Rcpp.h>
+#include <cstddef>
+#include <limits>
+#include <vector>
 
 Rcpp::NumericMatrix cost_matrix_diagonal_cpp(Rcpp::NumericMatrix dist_matrix);
 Rcpp::NumericMatrix cost_matrix_diagonal_weighted_cpp(Rcpp::NumericMatrix dist_matrix);
 Rcpp::NumericMatrix cost_matrix_orthogonal_cpp(Rcpp::NumericMatrix dist_matrix);
 
+// Step patterns of the cost matrix and the least cost path.
+enum StepPattern {
+  step_orthogonal,
+  step_symmetric1,
+  step_weighted,
+  step_symmetric2,
+  step_asymmetric
+};
+
+// Step patterns as compile-time types for cost_matrix_column_template(). Each
+// one lists the steps from the predecessors of a cell, in order of preference
+// in case of ties during the traceback (see cost_path_raw()), with the weight
+// applied to the distance of the cell when reached through each step. Steps
+// move back zero or one column (`dx`).
+
+// Orthogonal steps only, as cost_matrix_orthogonal_cpp().
+struct StepOrthogonal {
+  static const int count = 2;
+  static void step(int k, int& dx, int& dy, double& weight) {
+    static const int sx[2] = {0, -1};
+    static const int sy[2] = {-1, 0};
+    dx = sx[k];
+    dy = sy[k];
+    weight = 1.0;
+  }
+};
+
+// Orthogonal and diagonal steps with the same weight, as
+// cost_matrix_diagonal_cpp().
+struct StepSymmetric1 {
+  static const int count = 3;
+  static void step(int k, int& dx, int& dy, double& weight) {
+    static const int sx[3] = {-1, 0, -1};
+    static const int sy[3] = {-1, -1, 0};
+    dx = sx[k];
+    dy = sy[k];
+    weight = 1.0;
+  }
+};
+
+// Diagonal steps weighted by the square root of two, as
+// cost_matrix_diagonal_weighted_cpp().
+struct StepWeighted {
+  static const int count = 3;
+  static void step(int k, int& dx, int& dy, double& weight) {
+    static const int sx[3] = {-1, 0, -1};
+    static const int sy[3] = {-1, -1, 0};
+    static const double sw[3] = {1.414214, 1.0, 1.0};
+    dx = sx[k];
+    dy = sy[k];
+    weight = sw[k];
+  }
+};
+
+// Diagonal steps weighted by two, so all paths between two cells have the
+// same total weight (Sakoe and Chiba's symmetric2).
+struct StepSymmetric2 {
+  static const int count = 3;
+  static void step(int k, int& dx, int& dy, double& weight) {
+    static const int sx[3] = {-1, 0, -1};
+    static const int sy[3] = {-1, -1, 0};
+    static const double sw[3] = {2.0, 1.0, 1.0};
+    dx = sx[k];
+    dy = sy[k];
+    weight = sw[k];
+  }
+};
+
+// Steps advancing one sample of `x` and zero to two samples of `y`, so every
+// sample of `x` is matched exactly once (Rabiner and Juang's asymmetric).
+struct StepAsymmetric {
+  static const int count = 3;
+  static void step(int k, int& dx, int& dy, double& weight) {
+    static const int sx[3] = {-1, -1, -1};
+    static const int sy[3] = {-1, 0, -2};
+    dx = sx[k];
+    dy = sy[k];
+    weight = 1.0;
+  }
+};
+
+// Internal function to translate the arguments `diagonal` and `weighted` of
+// the exported functions into a step pattern. `weighted` is ignored when
+// `diagonal` is false.
+inline StepPattern cost_matrix_step_pattern(
+    bool diagonal,
+    bool weighted
+){
+
+  if (!diagonal) {
+    return step_orthogonal;
+  }
+
+  return weighted ? step_weighted : step_symmetric1;
+
+}
+
+// Internal functions to read the steps of a step pattern at run time, as
+// during the traceback of the least cost path.
+inline int cost_matrix_step_count(
+    StepPattern pattern
+){
+  return pattern == step_orthogonal ? StepOrthogonal::count : StepSymmetric1::count;
+}
+
+inline void cost_matrix_step(
+    StepPattern pattern,
+    int k,
+    int& dx,
+    int& dy,
+    double& weight
+){
+
+  switch (pattern) {
+  case step_orthogonal:
+    StepOrthogonal::step(k, dx, dy, weight);
+    break;
+  case step_symmetric1:
+    StepSymmetric1::step(k, dx, dy, weight);
+    break;
+  case step_symmetric2:
+    StepSymmetric2::step(k, dx, dy, weight);
+    break;
+  case step_asymmetric:
+    StepAsymmetric::step(k, dx, dy, weight);
+    break;
+  default:
+    StepWeighted::step(k, dx, dy, weight);
+  }
+
+}
+
+// Internal function to get the highest weight of the steps of a step pattern.
+inline double cost_matrix_step_max_weight(
+    StepPattern pattern
+){
+
+  int dx;
+  int dy;
+  double weight;
+  double max_weight = 1.0;
+
+  for (int k = 0; k < cost_matrix_step_count(pattern); ++k) {
+    cost_matrix_step(pattern, k, dx, dy, weight);
+    max_weight = weight > max_weight ? weight : max_weight;
+  }
+
+  return max_weight;
+
+}
+
+// Cells of a cost matrix the least cost path can visit, as the first (`lo`)
+// and last (`hi`) 0-based rows of `y` of each column (sample of `x`). Cells
+// outside of the window have infinite cost (see cost_window.h for the
+// windows available).
+struct CostWindow {
+  std::vector<int> lo;
+  std::vector<int> hi;
+};
+
+void cost_matrix_batch(
+    const double* dist_matrix,
+    double* cost_matrix,
+    int yn,
+    int xn,
+    int lanes,
+    StepPattern pattern,
+    const CostWindow* window = NULL
+);
+
+// Internal function to compute one column of `lanes` interleaved cost
+// matrices (see cost_matrix_batch()) from the same column of the distance
+// matrices and the previous column of the cost matrices (`cost_left`, NULL for
+// the first column), with the steps of `Pattern`. Each cell holds the lowest
+// cost of its predecessors plus its distance times the weight of the step.
+// Only rows `lo` to `hi` are computed, and the others have infinite cost, so
+// predecessors outside of the window are never used. The first row of the
+// first column holds its distance. When `open_begin` is true, the first row
+// of every column holds its distance, so paths may start at any column, as
+// in subsequence alignments. The return cost of the last cell is added by
+// cost_matrix_return(). Does not touch the R API.
+template <class Pattern>
+inline void cost_matrix_column_template(
+    const double* dist_column,
+    const double* cost_left,
+    double* cost_column,
+    int yn,
+    int lanes,
+    int lo,
+    int hi,
+    bool open_begin
+){
+
+  const double infinity = std::numeric_limits<double>::infinity();
+
+  int dx;
+  int dy;
+  double weight;
+
+  for (int i = 0; i < yn; ++i) {
+
+    double* out = cost_column + static_cast<std::size_t>(i) * lanes;
+
+    if (i < lo || i > hi) {
+      for (int k = 0; k < lanes; ++k) {
+        out[k] = infinity;
+      }
+      continue;
+    }
+
+    const double* current_dist = dist_column + static_cast<std::size_t>(i) * lanes;
+
+    if (i == 0 && (cost_left == NULL || open_begin)) {
+      for (int k = 0; k < lanes; ++k) {
+        out[k] = current_dist[k];
+      }
+      continue;
+    }
+
+    // The first step reaching the cell sets its cost, so NaN distances
+    // propagate as in cost_matrix_diagonal_cpp(). Steps within the column
+    // come first, as the vertical step in these functions.
+    bool first = true;
+
+    for (int pass = 0; pass < 2; ++pass) {
+
+      for (int s = 0; s < Pattern::count; ++s) {
+
+        Pattern::step(s, dx, dy, weight);
+
+        if ((dx == 0) != (pass == 0) || i + dy < 0 || (dx != 0 && cost_left == NULL)) {
+          continue;
+        }
+
+        const double* previous = (dx == 0 ? cost_column : cost_left) +
+          static_cast<std::size_t>(i + dy) * lanes;
+
+        if (first) {
+          for (int k = 0; k < lanes; ++k) {
+            out[k] = previous[k] + current_dist[k] * weight;
+          }
+          first = false;
+          continue;
+        }
+
+        for (int k = 0; k < lanes; ++k) {
+          double c = previous[k] + current_dist[k] * weight;
+          out[k] = c < out[k] ? c : out[k];
+        }
+
+      }
+
+    }
+
+    // No step reaches the cell
+    if (first) {
+      for (int k = 0; k < lanes; ++k) {
+        out[k] = infinity;
+      }
+    }
+
+  }
+
+}
+
+// Internal function to run the instantiation of cost_matrix_column_template()
+// for a step pattern. Shared by every engine that builds cost matrices column
+// by column, so all of them produce the same values. `hi` lower than zero
+// stands for the last row. Does not touch the R API.
+inline void cost_matrix_column(
+    const double* dist_column,
+    const double* cost_left,
+    double* cost_column,
+    int yn,
+    int lanes,
+    StepPattern pattern,
+    int lo = 0,
+    int hi = -1,
+    bool open_begin = false
+){
+
+  if (hi < 0) {
+    hi = yn - 1;
+  }
+
+  switch (pattern) {
+  case step_orthogonal:
+    cost_matrix_column_template<StepOrthogonal>(dist_column, cost_left, cost_column, yn, lanes, lo, hi, open_begin);
+    break;
+  case step_symmetric1:
+    cost_matrix_column_template<StepSymmetric1>(dist_column, cost_left, cost_column, yn, lanes, lo, hi, open_begin);
+    break;
+  case step_symmetric2:
+    cost_matrix_column_template<StepSymmetric2>(dist_column, cost_left, cost_column, yn, lanes, lo, hi, open_begin);
+    break;
+  case step_asymmetric:
+    cost_matrix_column_template<StepAsymmetric>(dist_column, cost_left, cost_column, yn, lanes, lo, hi, open_begin);
+    break;
+  default:
+    cost_matrix_column_template<StepWeighted>(dist_column, cost_left, cost_column, yn, lanes, lo, hi, open_begin);
+  }
+
+}
+
+// Internal function to add the return cost to the starting point to the last
+// cell of `lanes` interleaved cost matrices. Does not touch the R API.
+inline void cost_matrix_return(
+    double* cost_matrix,
+    int yn,
+    int xn,
+    int lanes
+){
+
+  double* last = cost_matrix + (static_cast<std::size_t>(xn) * yn - 1) * lanes;
+
+  for (int k = 0; k < lanes; ++k) {
+    last[k] += cost_matrix[k];
+  }
+
+}
+
 #endif // COST_MATRIX_H
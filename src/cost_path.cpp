@@ -3,6 +3,10 @@
 #include "distance_methods.h"
 #include "distance_matrix.h"
 #include "cost_matrix.h"
+#include "cost_path_raw.h"
+#include "alignment.h"
+#include "alignment_cache.h"
+#include "cost_window.h"
 using namespace Rcpp;
 
 //' (C++) Least Cost Path for Sequence Slotting
@@ -724,6 +728,38 @@ double cost_path_sum_cpp(
 //' NA values must be removed from \code{x} and \code{y} before using this function.
 //' If the selected distance function is "chi" or "cosine", pairs of zeros should
 //' be either removed or replaced with pseudo-zeros (i.e. 0.00001).
+//'
+//' Step patterns (argument `step_pattern`):
+//' \itemize{
+//'   \item "orthogonal": horizontal and vertical steps, as `diagonal = FALSE`.
+//'   \item "symmetric1": horizontal, vertical, and diagonal steps with the same
+//'   weight, as `diagonal = TRUE` and `weighted = FALSE`.
+//'   \item "weighted": diagonal steps weighted by 1.414214, as `diagonal = TRUE`
+//'   and `weighted = TRUE`.
+//'   \item "symmetric2": diagonal steps weighted by 2, so all paths have the
+//'   same total weight.
+//'   \item "asymmetric": each step advances one sample of `x` and zero to two
+//'   samples of `y`, so each sample of `x` is matched once. Requires `y` to
+//'   have at most about twice as many rows as `x`.
+//' }
+//' Windows (argument `window`), restricting the cells of the cost matrix
+//' computed by dynamic programming:
+//' \itemize{
+//'   \item "none": all cells.
+//'   \item "sakoe_chiba": band of `window_size` times the number of rows of `y`
+//'   at each side of the diagonal.
+//'   \item "itakura": Itakura parallelogram, with paths leaving the first cell
+//'   and reaching the last one with slopes between `1/slope` and `slope`
+//'   relative to the diagonal. With the default slope of 2 it holds about a
+//'   third of the cells of the cost matrix.
+//'   \item "envelope": rows `lower[i]` to `upper[i]` of `y` for each row `i`
+//'   of `x`.
+//' }
+//' Distances of cells outside of the window are not computed, their cost is
+//' infinite, and the least cost path never visits them, but distance and cost
+//' matrices still hold all cells. The argument `bandwidth` is a different restriction: the cost
+//' matrix is computed in full, and only the traceback of the least cost path
+//' is kept within its Sakoe-Chiba band. Both can be combined.
 //' @param x (required, numeric matrix) multivariate time series.
 //' @param y (required, numeric matrix) multivariate time series
 //' with the same number of columns as 'x'.
@@ -738,8 +774,36 @@ double cost_path_sum_cpp(
 //' @param bandwidth (required, numeric) Size of the Sakoe-Chiba band at
 //' both sides of the diagonal used to constrain the least cost path. Expressed
 //' as a fraction of the number of matrix rows and columns. Unrestricted by default.
+//' Only restricts the traceback of the least cost path (see `window_size`).
 //' Default: 1
+//' @param step_pattern (optional, character string) one of "orthogonal",
+//' "symmetric1", "weighted", "symmetric2", or "asymmetric". If NULL, defined by
+//' `diagonal` and `weighted`, which are otherwise ignored. Default: NULL
+//' @param window (optional, character string) one of "none", "sakoe_chiba",
+//' "itakura", or "envelope". Default: "none"
+//' @param window_size (optional, numeric) size of the Sakoe-Chiba window at
+//' both sides of the diagonal, as a fraction of the number of rows of `y`.
+//' Only relevant when `window` is "sakoe_chiba". Default: 1
+//' @param slope (optional, numeric) maximum slope of the Itakura
+//' parallelogram, higher than one. Only relevant when `window` is "itakura".
+//' Default: 2
+//' @param lower (optional, integer vector) first row of `y` admissible for
+//' each row of `x`. Only relevant when `window` is "envelope". Default: NULL
+//' @param upper (optional, integer vector) last row of `y` admissible for each
+//' row of `x`. Only relevant when `window` is "envelope". Default: NULL
 //' @return data frame
+//' @examples
+//' x <- zoo_simulate(seed = 1)
+//' y <- zoo_simulate(seed = 2)
+//'
+//' path <- cost_path_cpp(
+//'   x = x,
+//'   y = y,
+//'   step_pattern = "symmetric2",
+//'   window = "itakura"
+//' )
+//'
+//' head(path)
 //' @export
 //' @family Rcpp_cost_path
 // [[Rcpp::export]]
@@ -750,11 +814,95 @@ DataFrame cost_path_cpp(
    bool diagonal = true,
    bool weighted = true,
    bool ignore_blocks = false,
-   double bandwidth = 1
+   double bandwidth = 1,
+   Nullable<CharacterVector> step_pattern = R_NilValue,
+   const std::string& window = "none",
+   double window_size = 1,
+   double slope = 2,
+   Nullable<IntegerVector> lower = R_NilValue,
+   Nullable<IntegerVector> upper = R_NilValue
 ){
 
  if(!diagonal){weighted = false;}
 
+ //path computed in C++ with step patterns and windows, or taken from the
+ //cache of least cost paths (see alignment_cache_cpp())
+ if (alignment_cache_enabled() || !step_pattern.isNull() || window != "none") {
+
+   if (x.ncol() != y.ncol()) {
+     Rcpp::stop("distantia::cost_path_cpp(): 'x' and 'y' must have the same number of columns.");
+   }
+
+   DistanceFunctionRaw f = select_distance_function_raw(distance);
+
+   StepPattern pattern = cost_window_step_pattern_cpp(
+     step_pattern,
+     diagonal,
+     weighted,
+     "cost_path_cpp"
+   );
+
+   CostWindow cells;
+
+   const CostWindow* restricted = cost_window_build_cpp(
+     window,
+     x.nrow(),
+     y.nrow(),
+     window_size,
+     slope,
+     lower,
+     upper,
+     "cost_path_cpp",
+     cells
+   );
+
+   std::vector<double> x_rows = matrix_rows_cpp(x);
+   std::vector<double> y_rows = matrix_rows_cpp(y);
+
+   Alignment alignment;
+
+   bool found = alignment_compute_cpp(
+     x_rows.data(),
+     x.nrow(),
+     y_rows.data(),
+     y.nrow(),
+     x.ncol(),
+     f,
+     pattern,
+     restricted,
+     false,
+     bandwidth,
+     alignment
+   );
+
+   if (!found) {
+     Rcpp::stop("distantia::cost_path_cpp(): there is no path from the first to the last cell of the cost matrix within the window with this step pattern.");
+   }
+
+   int n = alignment.path.x.size();
+   IntegerVector path_x(n);
+   IntegerVector path_y(n);
+
+   for (int i = 0; i < n; i++) {
+     path_x[i] = alignment.path.x[i] + 1;
+     path_y[i] = alignment.path.y[i] + 1;
+   }
+
+   DataFrame cost_path = DataFrame::create(
+     _["x"] = path_x,
+     _["y"] = path_y,
+     _["dist"] = NumericVector(alignment.path.dist.begin(), alignment.path.dist.end()),
+     _["cost"] = NumericVector(alignment.path.cost.begin(), alignment.path.cost.end())
+   );
+
+   if (ignore_blocks){
+     cost_path = cost_path_trim_cpp(cost_path);
+   }
+
+   return cost_path;
+
+ }
+
  //distance matrix
  NumericMatrix dist_matrix = distance_matrix_cpp(
    x,
@@ -814,6 +962,187 @@ DataFrame cost_path_cpp(
 
 }
 
+// Internal function to compute a least cost path from distance and cost
+// matrices stored as plain buffers. When `lanes` is higher than one, the
+// buffers hold interleaved matrices (see cost_matrix_batch()), and `lane`
+// selects the one to trace. The path moves from the last cell to the
+// predecessor of lowest cost among the steps of `pattern` (see
+// cost_matrix.h), so cells of infinite cost (outside of the window of the
+// cost matrix, see cost_matrix_batch()) are never visited. With the step
+// patterns "symmetric2" and "asymmetric", the cost of a predecessor includes
+// the distance of the current cell times the weight of the step, so the path
+// is the one that produced the cost of the last cell. The other patterns
+// compare the costs of the predecessors only, as the functions below (the
+// same for "orthogonal" and "symmetric1", which have steps of weight one). `bandwidth` only
+// restricts the traceback to a Sakoe-Chiba band, without changing the cost
+// matrix. With the step patterns "orthogonal", "symmetric1", and "weighted",
+// produces the same path as cost_path_diagonal_cpp(),
+// cost_path_orthogonal_cpp(), and their bandwidth restricted versions.
+// Does not touch the R API.
+void cost_path_raw(
+    const double* dist_matrix,
+    const double* cost_matrix,
+    int d_rows,
+    int d_cols,
+    StepPattern pattern,
+    double bandwidth,
+    CostPath& path,
+    int lanes,
+    int lane
+){
+
+  if (bandwidth < 0.0) {
+    bandwidth = 0.0;
+  } else if (bandwidth > 1.0) {
+    bandwidth = 1.0;
+  }
+
+  bool restricted = bandwidth < 1.0;
+
+  path.x.clear();
+  path.y.clear();
+  path.dist.clear();
+  path.cost.clear();
+
+  // Position of a cell of the selected matrix in the buffers
+  auto cell = [&](int y, int x) -> std::size_t {
+    return (static_cast<std::size_t>(x) * d_rows + y) * lanes + lane;
+  };
+
+  // Define Sakoe-Chiba band boundaries
+  auto y_min = [&](int x) -> int {
+    return std::max(0, static_cast<int>(static_cast<long long>(x) * d_rows / d_cols - bandwidth * d_rows));
+  };
+
+  auto y_max = [&](int x) -> int {
+    return std::min(d_rows - 1, static_cast<int>(static_cast<long long>(x) * d_rows / d_cols + bandwidth * d_rows));
+  };
+
+  // Neighbors in order of preference in case of ties
+  int n_neighbors = cost_matrix_step_count(pattern);
+  int neighbor_dx[3];
+  int neighbor_dy[3];
+  double neighbor_weight[3];
+
+  for (int i = 0; i < n_neighbors; ++i) {
+    cost_matrix_step(pattern, i, neighbor_dx[i], neighbor_dy[i], neighbor_weight[i]);
+  }
+
+  // Weights of the steps in the traceback
+  bool step_weights = pattern == step_symmetric2 || pattern == step_asymmetric;
+
+  // Define initial coordinates
+  int x = d_cols - 1;
+  int y = d_rows - 1;
+
+  // Iterate to find the path
+  while (true) {
+
+    std::size_t current = cell(y, x);
+    path.x.push_back(x);
+    path.y.push_back(y);
+    path.dist.push_back(dist_matrix[current]);
+    path.cost.push_back(cost_matrix[current]);
+
+    // Find neighbor with minimum cost
+    int min_cost_neighbor = -1;
+    double min_cost = std::numeric_limits<double>::max();
+    double current_dist = std::isnan(dist_matrix[current]) ? 0.0 : dist_matrix[current];
+
+    for (int i = 0; i < n_neighbors; ++i) {
+
+      int nx = x + neighbor_dx[i];
+      int ny = y + neighbor_dy[i];
+
+      if (nx < 0 || ny < 0) {
+        continue;
+      }
+
+      // check if the neighbor is within the Sakoe-Chiba band
+      if (restricted && (ny < y_min(nx) || ny > y_max(nx))) {
+        continue;
+      }
+
+      double neighbor_cost = cost_matrix[cell(ny, nx)];
+
+      if (step_weights) {
+        neighbor_cost += neighbor_weight[i] * current_dist;
+      }
+
+      if (neighbor_cost < min_cost) {
+        min_cost = neighbor_cost;
+        min_cost_neighbor = i;
+      }
+
+    }
+
+    // Check for termination
+    if (min_cost_neighbor == -1) {
+      break;
+    }
+
+    // Update current coordinates
+    x += neighbor_dx[min_cost_neighbor];
+    y += neighbor_dy[min_cost_neighbor];
+
+  }
+
+}
+
+// Internal function to remove blocks from a least cost path.
+// Same logic as cost_path_trim_cpp().
+void cost_path_trim_raw(
+    CostPath& path
+){
+
+  int n = path.x.size();
+  std::vector<bool> keep(n, true);
+
+  for (int i = 1; i < n - 1; ++i) {
+    if (
+        (path.y[i] == path.y[i - 1] && path.y[i] == path.y[i + 1]) ||
+        (path.x[i] == path.x[i - 1] && path.x[i] == path.x[i + 1])
+    ) {
+      keep[i] = false;
+    }
+  }
+
+  int l = 0;
+  for (int i = 0; i < n; ++i) {
+    if (keep[i]) {
+      path.x[l] = path.x[i];
+      path.y[l] = path.y[i];
+      path.dist[l] = path.dist[i];
+      path.cost[l] = path.cost[i];
+      ++l;
+    }
+  }
+
+  path.x.resize(l);
+  path.y.resize(l);
+  path.dist.resize(l);
+  path.cost.resize(l);
+
+}
+
+// Internal function to sum distances in a least cost path.
+// Same logic as cost_path_sum_cpp().
+double cost_path_sum_raw(
+    const CostPath& path
+){
+
+  double dist = 0.0;
+
+  for (double d : path.dist) {
+    dist += d;
+  }
+
+  // rounding to 8 decimal places
+  double factor = std::pow(10.0, 8);
+  return std::round(dist * factor) / factor;
+
+}
+
 // You can include R code blocks in C++ files processed with sourceCpp
 // (useful for testing and development). The R code will be automatically
 // run after the compilation.
@@ -38,7 +38,13 @@ Rcpp::DataFrame cost_path_cpp(
     bool diagonal = false,
     bool weighted = false,
     bool ignore_blocks = false,
-    double bandwidth = 1
+    double bandwidth = 1,
+    Rcpp::Nullable<Rcpp::CharacterVector> step_pattern = R_NilValue,
+    const std::string& window = "none",
+    double window_size = 1,
+    double slope = 2,
+    Rcpp::Nullable<Rcpp::IntegerVector> lower = R_NilValue,
+    Rcpp::Nullable<Rcpp::IntegerVector> upper = R_NilValue
 );
 
 #endif // COST_PATH_H
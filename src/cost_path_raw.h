@@ -0,0 +1,38 @@
+#ifndef COST_PATH_RAW_H
+#define COST_PATH_RAW_H
+
+#include <vector>
+#include "cost_matrix.h"
+
+// Least cost path stored as plain C++ vectors, used by the engines that work
+// outside of the R API. Coordinates are 0-based, and ordered from the last
+// cell of the cost matrix to the first, as in the data frames returned by
+// cost_path_cpp().
+struct CostPath {
+  std::vector<int> x;
+  std::vector<int> y;
+  std::vector<double> dist;
+  std::vector<double> cost;
+};
+
+void cost_path_raw(
+    const double* dist_matrix,
+    const double* cost_matrix,
+    int d_rows,
+    int d_cols,
+    StepPattern pattern,
+    double bandwidth,
+    CostPath& path,
+    int lanes = 1,
+    int lane = 0
+);
+
+void cost_path_trim_raw(
+    CostPath& path
+);
+
+double cost_path_sum_raw(
+    const CostPath& path
+);
+
+#endif // COST_PATH_RAW_H
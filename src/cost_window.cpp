@@ -0,0 +1,293 @@
+#include <Rcpp.h>
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include "cost_matrix.h"
+#include "cost_window.h"
+using namespace Rcpp;
+
+// Internal function to widen the columns of a window so consecutive columns
+// overlap or touch, and the first and last cells of the cost matrix are
+// admissible.
+void cost_window_connect(
+    int yn,
+    CostWindow& window
+){
+
+  int xn = static_cast<int>(window.lo.size());
+
+  window.lo[0] = 0;
+  window.hi[xn - 1] = yn - 1;
+
+  for (int x = 0; x < xn; ++x) {
+    if (x > 0) {
+      window.lo[x] = std::min(window.lo[x], window.hi[x - 1] + 1);
+    }
+    window.hi[x] = std::max(window.hi[x], window.lo[x]);
+  }
+
+}
+
+// Internal function to build a window with all cells of the cost matrix.
+void cost_window_full(
+    int xn,
+    int yn,
+    CostWindow& window
+){
+
+  window.lo.assign(xn, 0);
+  window.hi.assign(xn, yn - 1);
+
+}
+
+// Internal function to build a Sakoe-Chiba window of `size` times the
+// number of rows of `y` at each side of the diagonal, with the bounds of the
+// band of cost_path_raw().
+void cost_window_sakoe_chiba(
+    int xn,
+    int yn,
+    double size,
+    CostWindow& window
+){
+
+  size = std::min(1.0, std::max(0.0, size));
+
+  window.lo.resize(xn);
+  window.hi.resize(xn);
+
+  for (int x = 0; x < xn; ++x) {
+    long long center = static_cast<long long>(x) * yn / xn;
+    window.lo[x] = std::max(0, static_cast<int>(center - size * yn));
+    window.hi[x] = std::min(yn - 1, static_cast<int>(center + size * yn));
+  }
+
+  cost_window_connect(yn, window);
+
+}
+
+// Internal function to build an Itakura parallelogram window: cells reachable
+// from the first cell and reaching the last cell with slopes between
+// 1 / `slope` and `slope`, relative to the diagonal of the cost matrix. The
+// cells of the diagonal are always admissible.
+void cost_window_itakura(
+    int xn,
+    int yn,
+    double slope,
+    CostWindow& window
+){
+
+  if (xn < 2 || yn < 2) {
+    cost_window_full(xn, yn, window);
+    return;
+  }
+
+  window.lo.resize(xn);
+  window.hi.resize(xn);
+
+  double tolerance = 1e-9;
+
+  for (int x = 0; x < xn; ++x) {
+
+    //position along x, and bounds as fractions of y
+    double u = static_cast<double>(x) / (xn - 1);
+    double v_lo = std::max(u / slope, 1.0 - slope * (1.0 - u));
+    double v_hi = std::min(slope * u, 1.0 - (1.0 - u) / slope);
+
+    int diagonal = static_cast<int>(std::round(u * (yn - 1)));
+
+    window.lo[x] = std::min(diagonal, std::max(0, static_cast<int>(std::ceil(v_lo * (yn - 1) - tolerance))));
+    window.hi[x] = std::max(diagonal, std::min(yn - 1, static_cast<int>(std::floor(v_hi * (yn - 1) + tolerance))));
+
+  }
+
+  cost_window_connect(yn, window);
+
+}
+
+// Internal function to build a window with the cells between the diagonals
+// of offsets `offset_lo` and `offset_hi`, with sample `x` of `x` against
+// samples `x + offset_lo` to `x + offset_hi` of `y`.
+void cost_window_offset(
+    int xn,
+    int yn,
+    int offset_lo,
+    int offset_hi,
+    CostWindow& window
+){
+
+  window.lo.resize(xn);
+  window.hi.resize(xn);
+
+  for (int x = 0; x < xn; ++x) {
+    window.lo[x] = std::max(0, x + offset_lo);
+    window.hi[x] = std::min(yn - 1, x + offset_hi);
+  }
+
+}
+
+// Internal function to translate the argument `step_pattern` of the exported
+// functions.
+StepPattern cost_window_step_pattern_cpp(
+    const std::string& step_pattern,
+    const std::string& function_name
+){
+
+  if (step_pattern == "orthogonal") {
+    return step_orthogonal;
+  }
+
+  if (step_pattern == "symmetric1") {
+    return step_symmetric1;
+  }
+
+  if (step_pattern == "weighted") {
+    return step_weighted;
+  }
+
+  if (step_pattern == "symmetric2") {
+    return step_symmetric2;
+  }
+
+  if (step_pattern == "asymmetric") {
+    return step_asymmetric;
+  }
+
+  Rcpp::stop("distantia::" + function_name + "(): argument 'step_pattern' must be one of 'orthogonal', 'symmetric1', 'weighted', 'symmetric2', or 'asymmetric'.");
+
+}
+
+// Internal function to translate the arguments `step_pattern`, `diagonal`,
+// and `weighted` of the exported functions: `diagonal` and `weighted` are
+// only used when `step_pattern` is NULL.
+StepPattern cost_window_step_pattern_cpp(
+    Nullable<CharacterVector> step_pattern,
+    bool diagonal,
+    bool weighted,
+    const std::string& function_name
+){
+
+  if (step_pattern.isNull()) {
+    return cost_matrix_step_pattern(diagonal, weighted);
+  }
+
+  CharacterVector name(step_pattern.get());
+
+  if (name.size() != 1) {
+    Rcpp::stop("distantia::" + function_name + "(): argument 'step_pattern' must be NULL or a character string.");
+  }
+
+  return cost_window_step_pattern_cpp(
+    Rcpp::as<std::string>(name[0]),
+    function_name
+  );
+
+}
+
+// Internal function to translate the arguments `window`, `window_size`, and
+// `slope` of the exported functions comparing many pairs of time series.
+CostWindowSpec cost_window_spec_cpp(
+    const std::string& window,
+    double window_size,
+    double slope,
+    const std::string& function_name
+){
+
+  CostWindowSpec spec;
+  spec.size = window_size;
+  spec.slope = slope;
+
+  if (window == "none") {
+    spec.type = window_none;
+  } else if (window == "sakoe_chiba") {
+    spec.type = window_sakoe_chiba;
+  } else if (window == "itakura") {
+    spec.type = window_itakura;
+  } else {
+    Rcpp::stop("distantia::" + function_name + "(): argument 'window' must be one of 'none', 'sakoe_chiba', or 'itakura'.");
+  }
+
+  if (spec.type == window_itakura && !(slope > 1.0)) {
+    Rcpp::stop("distantia::" + function_name + "(): argument 'slope' must be a number higher than one.");
+  }
+
+  return spec;
+
+}
+
+// Internal function to build the window of a pair of time series with `xn`
+// and `yn` rows from its specification. Returns NULL for the window "none",
+// so the full cost matrix is computed. Does not touch the R API.
+const CostWindow* cost_window_spec_build(
+    const CostWindowSpec& spec,
+    int xn,
+    int yn,
+    CostWindow& window
+){
+
+  if (spec.type == window_sakoe_chiba) {
+    cost_window_sakoe_chiba(xn, yn, spec.size, window);
+    return &window;
+  }
+
+  if (spec.type == window_itakura) {
+    cost_window_itakura(xn, yn, spec.slope, window);
+    return &window;
+  }
+
+  return NULL;
+
+}
+
+// Internal function to build the window of the exported functions comparing
+// two time series from their arguments `window`, `window_size`, `slope`,
+// `lower`, and `upper`. Returns NULL for the window "none".
+const CostWindow* cost_window_build_cpp(
+    const std::string& window,
+    int xn,
+    int yn,
+    double window_size,
+    double slope,
+    Nullable<IntegerVector> lower,
+    Nullable<IntegerVector> upper,
+    const std::string& function_name,
+    CostWindow& out
+){
+
+  if (window != "none" && window != "sakoe_chiba" && window != "itakura" && window != "envelope") {
+    Rcpp::stop("distantia::" + function_name + "(): argument 'window' must be one of 'none', 'sakoe_chiba', 'itakura', or 'envelope'.");
+  }
+
+  if (window != "envelope") {
+    return cost_window_spec_build(
+      cost_window_spec_cpp(window, window_size, slope, function_name),
+      xn,
+      yn,
+      out
+    );
+  }
+
+  if (lower.isNull() || upper.isNull()) {
+    Rcpp::stop("distantia::" + function_name + "(): arguments 'lower' and 'upper' are required when 'window' is 'envelope'.");
+  }
+
+  IntegerVector lo(lower.get());
+  IntegerVector hi(upper.get());
+
+  if (lo.size() != xn || hi.size() != xn) {
+    Rcpp::stop("distantia::" + function_name + "(): arguments 'lower' and 'upper' must have one value per row of 'x'.");
+  }
+
+  out.lo.resize(xn);
+  out.hi.resize(xn);
+
+  for (int x = 0; x < xn; ++x) {
+    if (lo[x] == NA_INTEGER || hi[x] == NA_INTEGER || lo[x] < 1 || hi[x] > yn || lo[x] > hi[x]) {
+      Rcpp::stop("distantia::" + function_name + "(): arguments 'lower' and 'upper' must be rows of 'y', with 'lower' not higher than 'upper'.");
+    }
+    out.lo[x] = lo[x] - 1;
+    out.hi[x] = hi[x] - 1;
+  }
+
+  return &out;
+
+}
@@ -0,0 +1,93 @@
+#ifndef COST_WINDOW_H
+#define COST_WINDOW_H
+
+#include <Rcpp.h>
+#include <string>
+#include <vector>
+#include "cost_matrix.h"
+
+// Windows of the cost matrix built from the number of rows of the time
+// series (see cost_window_spec_build()).
+enum CostWindowType {
+  window_none,
+  window_sakoe_chiba,
+  window_itakura
+};
+
+// Window of the engines comparing many pairs of time series, built for each
+// pair from its number of rows (see cost_window_spec_build()). `size` is the
+// half-width of the Sakoe-Chiba window, and `slope` the maximum slope of the
+// Itakura parallelogram.
+struct CostWindowSpec {
+  CostWindowType type = window_none;
+  double size = 1.0;
+  double slope = 2.0;
+};
+
+void cost_window_full(
+    int xn,
+    int yn,
+    CostWindow& window
+);
+
+void cost_window_sakoe_chiba(
+    int xn,
+    int yn,
+    double size,
+    CostWindow& window
+);
+
+void cost_window_itakura(
+    int xn,
+    int yn,
+    double slope,
+    CostWindow& window
+);
+
+void cost_window_offset(
+    int xn,
+    int yn,
+    int offset_lo,
+    int offset_hi,
+    CostWindow& window
+);
+
+const CostWindow* cost_window_spec_build(
+    const CostWindowSpec& spec,
+    int xn,
+    int yn,
+    CostWindow& window
+);
+
+StepPattern cost_window_step_pattern_cpp(
+    const std::string& step_pattern,
+    const std::string& function_name
+);
+
+StepPattern cost_window_step_pattern_cpp(
+    Rcpp::Nullable<Rcpp::CharacterVector> step_pattern,
+    bool diagonal,
+    bool weighted,
+    const std::string& function_name
+);
+
+CostWindowSpec cost_window_spec_cpp(
+    const std::string& window,
+    double window_size,
+    double slope,
+    const std::string& function_name
+);
+
+const CostWindow* cost_window_build_cpp(
+    const std::string& window,
+    int xn,
+    int yn,
+    double window_size,
+    double slope,
+    Rcpp::Nullable<Rcpp::IntegerVector> lower,
+    Rcpp::Nullable<Rcpp::IntegerVector> upper,
+    const std::string& function_name,
+    CostWindow& out
+);
+
+#endif // COST_WINDOW_H
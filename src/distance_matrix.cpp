@@ -1,7 +1,116 @@
 #include <Rcpp.h>
 #include "distance_methods.h"
+#include "column_view.h"
+#include "cost_matrix.h"
 using namespace Rcpp;
 
+// Internal function to copy a matrix into a row-major buffer, so each row
+// (time series sample) is contiguous in memory.
+std::vector<double> matrix_rows_cpp(
+    NumericMatrix x
+){
+
+  int rows = x.nrow();
+  int cols = x.ncol();
+
+  std::vector<double> x_rows(static_cast<std::size_t>(rows) * cols);
+
+  for (int j = 0; j < cols; j++) {
+    for (int i = 0; i < rows; i++) {
+      x_rows[static_cast<std::size_t>(i) * cols + j] = x(i, j);
+    }
+  }
+
+  return x_rows;
+
+}
+
+// Internal function to fill a distance matrix from two row-major buffers.
+// The output follows the layout of distance_matrix_cpp() (rows of `y` by
+// rows of `x`, column-major). When `lanes` is higher than one, each cell is
+// written every `lanes` positions, so several distance matrices of the same
+// shape can be interleaved in one buffer. When `window` is not NULL, only the
+// cells of the window (see cost_matrix_batch()) are filled, and the others
+// are left untouched. Does not touch the R API.
+void distance_matrix_raw(
+    const double* x,
+    int xn,
+    const double* y,
+    int yn,
+    int cols,
+    DistanceFunctionRaw f,
+    double* D,
+    int lanes = 1,
+    const CostWindow* window = NULL
+){
+
+  for (int j = 0; j < xn; j++) {
+    const double* x_row = x + static_cast<std::size_t>(j) * cols;
+    double* D_col = D + static_cast<std::size_t>(j) * yn * lanes;
+    int lo = window == NULL ? 0 : window->lo[j];
+    int hi = window == NULL ? yn - 1 : window->hi[j];
+    for (int i = lo; i <= hi; i++) {
+      D_col[static_cast<std::size_t>(i) * lanes] = f(y + static_cast<std::size_t>(i) * cols, x_row, cols);
+    }
+  }
+
+}
+
+
+// Internal function to fill the distance matrices of several distance
+// functions in one sweep over the pairs of rows of two row-major buffers, so
+// the rows are read once for all matrices. `D[k]` receives the matrix of
+// `f[k]`, with the layout of distance_matrix_raw(). The distances based on
+// absolute differences ("euclidean", "manhattan", and "chebyshev") share one
+// pass over the elements of each pair of rows. Does not touch the R API.
+void distance_matrix_multi_raw(
+    const double* x,
+    int xn,
+    const double* y,
+    int yn,
+    int cols,
+    const std::vector<DistanceFunctionRaw>& f,
+    const std::vector<double*>& D
+){
+
+  std::size_t k_n = f.size();
+
+  //fused pass only when it replaces at least two kernels
+  std::vector<int> differences(k_n);
+  int n_differences = 0;
+
+  for (std::size_t k = 0; k < k_n; k++) {
+    differences[k] = distance_differences_index(f[k]);
+    n_differences += differences[k] >= 0;
+  }
+
+  bool any_differences = n_differences > 1;
+
+  if (!any_differences) {
+    std::fill(differences.begin(), differences.end(), -1);
+  }
+
+  double fused[3] = {0.0, 0.0, 0.0};
+
+  for (int j = 0; j < xn; j++) {
+    const double* x_row = x + static_cast<std::size_t>(j) * cols;
+    for (int i = 0; i < yn; i++) {
+
+      const double* y_row = y + static_cast<std::size_t>(i) * cols;
+      std::size_t cell = static_cast<std::size_t>(j) * yn + i;
+
+      if (any_differences) {
+        distance_differences_raw(y_row, x_row, cols, fused[0], fused[1], fused[2]);
+      }
+
+      for (std::size_t k = 0; k < k_n; k++) {
+        D[k][cell] = differences[k] >= 0 ? fused[differences[k]] : f[k](y_row, x_row, cols);
+      }
+
+    }
+  }
+
+}
 
 //' (C++) Distance Matrix of Two Time Series
 //' @description Computes the distance matrix between the rows of two matrices
@@ -35,17 +144,25 @@ NumericMatrix distance_matrix_cpp(
     const std::string& distance = "euclidean"
 ){
 
-  DistanceFunction f = select_distance_function_cpp(distance);
+  DistanceFunctionRaw f = select_distance_function_raw(distance);
 
   int yn = y.nrow();
   int xn = x.nrow();
   NumericMatrix D(yn, xn);
 
-  for (int i = 0; i < yn; i++) {
-    for (int j = 0; j < xn; j++) {
-      D(i, j) = f(y.row(i), x.row(j));
-    }
-  }
+  //row-major copies to access rows as contiguous memory
+  std::vector<double> x_rows = matrix_rows_cpp(x);
+  std::vector<double> y_rows = matrix_rows_cpp(y);
+
+  distance_matrix_raw(
+    x_rows.data(),
+    xn,
+    y_rows.data(),
+    yn,
+    x.ncol(),
+    f,
+    D.begin()
+  );
 
   return D;
 }
@@ -106,6 +223,61 @@ double distance_ls_cpp(
 }
 
 
+// Internal function to compute the lock-step sum of distances between two
+// column views (see distance_ls_cpp()) without copying their matrices.
+double distance_ls_view_cpp(
+    const ColumnView& x,
+    const ColumnView& y,
+    DistanceFunctionRaw f
+){
+
+  int yn = y.nrow;
+  int cols = y.ncol();
+
+  std::vector<double> x_row(cols);
+  std::vector<double> y_row(cols);
+
+  double D = 0.0;
+
+  for (int i = 0; i < yn; i++) {
+    y.row(i, y_row.data());
+    x.row(i, x_row.data());
+    D += f(y_row.data(), x_row.data(), cols);
+  }
+
+  return D;
+}
+
+// Internal function to fill a distance matrix between two column views, with
+// the layout of distance_matrix_raw(), reading the values from the memory of
+// their matrices. Each row of `x` is gathered once into a scratch row of the
+// size of a sample, and each row of `y` once per column of the matrix, so the
+// views are never staged as whole matrices. Does not touch the R API.
+void distance_matrix_view_raw(
+    const ColumnView& x,
+    const ColumnView& y,
+    DistanceFunctionRaw f,
+    double* D
+){
+
+  int xn = x.nrow;
+  int yn = y.nrow;
+  int cols = y.ncol();
+
+  std::vector<double> x_row(cols);
+  std::vector<double> y_row(cols);
+
+  for (int j = 0; j < xn; j++) {
+    x.row(j, x_row.data());
+    double* D_col = D + static_cast<std::size_t>(j) * yn;
+    for (int i = 0; i < yn; i++) {
+      y.row(i, y_row.data());
+      D_col[i] = f(y_row.data(), x_row.data(), cols);
+    }
+  }
+
+}
+
 // You can include R code blocks in C++ files processed with sourceCpp
 // (useful for testing and development). The R code will be automatically
 // run after the compilation.
@@ -3,6 +3,8 @@
 
 #include <Rcpp.h>
 #include "distance_methods.h"
+#include "column_view.h"
+#include "cost_matrix.h"
 
 Rcpp::NumericMatrix distance_matrix_cpp(
     Rcpp::NumericMatrix a,
@@ -16,5 +18,44 @@ double distance_ls_cpp(
     const std::string& distance = "euclidean"
 );
 
+std::vector<double> matrix_rows_cpp(
+    Rcpp::NumericMatrix x
+);
+
+void distance_matrix_raw(
+    const double* x,
+    int xn,
+    const double* y,
+    int yn,
+    int cols,
+    DistanceFunctionRaw f,
+    double* D,
+    int lanes = 1,
+    const CostWindow* window = NULL
+);
+
+void distance_matrix_multi_raw(
+    const double* x,
+    int xn,
+    const double* y,
+    int yn,
+    int cols,
+    const std::vector<DistanceFunctionRaw>& f,
+    const std::vector<double*>& D
+);
+
+double distance_ls_view_cpp(
+    const ColumnView& x,
+    const ColumnView& y,
+    DistanceFunctionRaw f
+);
+
+void distance_matrix_view_raw(
+    const ColumnView& x,
+    const ColumnView& y,
+    DistanceFunctionRaw f,
+    double* D
+);
+
 #endif // DISTANCE_MATRIX_CPP_H
 
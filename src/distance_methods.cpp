@@ -1,18 +1,19 @@
 #include <Rcpp.h>
+#include "distance_methods.h"
 using namespace Rcpp;
 
-//' (C++) Chebyshev Distance Between Two Vectors
-//' @description Computed as: \code{max(abs(x - y))}. Cannot handle NA values.
-//' @param x (required, numeric vector).
-//' @param y (required, numeric vector) of same length as `x`.
-//' @return numeric
-//' @examples distance_chebyshev_cpp(x = runif(100), y = runif(100))
-//' @export
-//' @family Rcpp_distance_methods
-// [[Rcpp::export]]
-double distance_chebyshev_cpp(NumericVector x, NumericVector y) {
+// Distance kernels on contiguous memory.
+// These are the actual implementations of the distance methods. They are
+// shared by the exported functions below and by the engines that stage time
+// series as row-major buffers, which avoids allocating one R vector per row.
+// They do not touch the R API, and can be used from worker threads.
 
-  int length = x.size();
+// Chebyshev distance between two rows of length `length`
+double distance_chebyshev_raw(
+    const double* x,
+    const double* y,
+    int length
+) {
 
   double dist = 0.0;
 
@@ -29,18 +30,12 @@ double distance_chebyshev_cpp(NumericVector x, NumericVector y) {
 
 }
 
-//' (C++) Jaccard Distance Between Two Binary Vectors
-//' @description Computes the Jaccard distance between two binary vectors.
-//' @param x (required, numeric vector).
-//' @param y (required, numeric vector) of same length as `x`.
-//' @return numeric
-//' @examples distance_jaccard_cpp(x = c(0, 1, 0, 1), y = c(1, 1, 0, 0))
-//' @export
-//' @family Rcpp_distance_methods
-// [[Rcpp::export]]
-double distance_jaccard_cpp(NumericVector x, NumericVector y) {
-
-  int length = x.size();
+// Jaccard distance between two rows of length `length`
+double distance_jaccard_raw(
+    const double* x,
+    const double* y,
+    int length
+) {
 
   double intersection = 0.0;
   double union_count = 0.0;
@@ -59,21 +54,15 @@ double distance_jaccard_cpp(NumericVector x, NumericVector y) {
   }
 
   return 1.0 - (intersection / union_count);
-}
 
+}
 
-//' (C++) Manhattan Distance Between Two Vectors
-//' @description Computed as: \code{sum(abs(x - y))}. Cannot handle NA values.
-//' @param x (required, numeric vector).
-//' @param y (required, numeric vector) of same length as `x`.
-//' @return numeric
-//' @examples distance_manhattan_cpp(x = runif(100), y = runif(100))
-//' @export
-//' @family Rcpp_distance_methods
-// [[Rcpp::export]]
-double distance_manhattan_cpp(NumericVector x, NumericVector y) {
-
-  int length = x.size();
+// Manhattan distance between two rows of length `length`
+double distance_manhattan_raw(
+    const double* x,
+    const double* y,
+    int length
+) {
 
   double dist = 0.0;
 
@@ -87,18 +76,12 @@ double distance_manhattan_cpp(NumericVector x, NumericVector y) {
 
 }
 
-//' (C++) Euclidean Distance Between Two Vectors
-//' @description Computed as: \code{sqrt(sum((x - y)^2)}. Cannot handle NA values.
-//' @param x (required, numeric vector).
-//' @param y (required, numeric vector) of same length as `x`.
-//' @return numeric
-//' @examples distance_euclidean_cpp(x = runif(100), y = runif(100))
-//' @export
-//' @family Rcpp_distance_methods
-// [[Rcpp::export]]
-double distance_euclidean_cpp(NumericVector x, NumericVector y) {
-
-  int length = x.size();
+// Euclidean distance between two rows of length `length`
+double distance_euclidean_raw(
+    const double* x,
+    const double* y,
+    int length
+) {
 
   double dist = 0.0;
 
@@ -112,19 +95,12 @@ double distance_euclidean_cpp(NumericVector x, NumericVector y) {
 
 }
 
-//' (C++) Hellinger Distance Between Two Vectors
-//' @description Computed as: \code{sqrt(1/2 * sum((sqrt(x) - sqrt(y))^2))}.
-//' Cannot handle NA values.
-//' @param x (required, numeric vector).
-//' @param y (required, numeric vector) of same length as `x`.
-//' @return numeric
-//' @examples distance_hellinger_cpp(x = runif(100), y = runif(100))
-//' @export
-//' @family Rcpp_distance_methods
-// [[Rcpp::export]]
-double distance_hellinger_cpp(NumericVector x, NumericVector y) {
-
-  int length = x.size();
+// Hellinger distance between two rows of length `length`
+double distance_hellinger_raw(
+    const double* x,
+    const double* y,
+    int length
+) {
 
   double dist = 0.0;
 
@@ -138,31 +114,22 @@ double distance_hellinger_cpp(NumericVector x, NumericVector y) {
 
 }
 
-//' (C++) Normalized Chi Distance Between Two Vectors
-//' @description Computed as:
-//' \code{xy <- x + y}
-//' \code{y. <- y / sum(y)}
-//' \code{x. <- x / sum(x)}
-//' \code{sqrt(sum(((x. - y.)^2) / (xy / sum(xy))))}.
-//' Cannot handle NA values. When \code{x} and \code{y} have zeros in the same
-//' position, \code{NaNs} are produced. Please replace these zeros with
-//' pseudo-zeros (i.e. 0.0001) if you wish to use this distance metric.
-//' @examples distance_chi_cpp(x = runif(100), y = runif(100))
-//' @param x (required, numeric vector).
-//' @param y (required, numeric vector) of same length as `x`.
-//' @return numeric
-//' @export
-//' @family Rcpp_distance_methods
-// [[Rcpp::export]]
-double distance_chi_cpp(NumericVector x, NumericVector y) {
-
-  int length = x.size();
+// Normalized chi distance between two rows of length `length`
+double distance_chi_raw(
+    const double* x,
+    const double* y,
+    int length
+) {
 
   double dist = 0.0;
 
-  double x_sum = sum(x);
+  double x_sum = 0.0;
+  double y_sum = 0.0;
 
-  double y_sum = sum(y);
+  for (int i = 0; i < length; i++) {
+    x_sum += x[i];
+    y_sum += y[i];
+  }
 
   double xy_sum = x_sum + y_sum;
 
@@ -179,18 +146,12 @@ double distance_chi_cpp(NumericVector x, NumericVector y) {
 
 }
 
-//' (C++) Canberra Distance Between Two Binary Vectors
-//' @description Computes the Canberra distance between two binary vectors.
-//' @param x (required, numeric vector).
-//' @param y (required, numeric vector) of same length as `x`.
-//' @return numeric
-//' @examples distance_canberra_cpp(c(0, 1, 0, 1), c(1, 1, 0, 0))
-//' @export
-//' @family Rcpp_distance_methods
-// [[Rcpp::export]]
-double distance_canberra_cpp(NumericVector x, NumericVector y) {
-
-  int length = x.size();
+// Canberra distance between two rows of length `length`
+double distance_canberra_raw(
+    const double* x,
+    const double* y,
+    int length
+) {
 
   double dist = 0.0;
 
@@ -203,20 +164,15 @@ double distance_canberra_cpp(NumericVector x, NumericVector y) {
   }
 
   return dist;
-}
 
-//' (C++) Russell-Rao Distance Between Two Binary Vectors
-//' @description Computes the Russell-Rao distance between two binary vectors.
-//' @param x (required, numeric). Binary vector of 1s and 0s.
-//' @param y (required, numeric) Binary vector of 1s and 0s of same length as `x`.
-//' @return numeric
-//' @examples distance_russelrao_cpp(c(0, 1, 0, 1), c(1, 1, 0, 0))
-//' @export
-//' @family Rcpp_distance_methods
-// [[Rcpp::export]]
-double distance_russelrao_cpp(NumericVector x, NumericVector y) {
+}
 
-  int length = x.size();
+// Russell-Rao distance between two rows of length `length`
+double distance_russelrao_raw(
+    const double* x,
+    const double* y,
+    int length
+) {
 
   double dist = 0.0;
 
@@ -227,21 +183,15 @@ double distance_russelrao_cpp(NumericVector x, NumericVector y) {
   }
 
   return 1.0 - (dist / length);
-}
-
 
-//' (C++) Cosine Dissimilarity Between Two Vectors
-//' @description Computes the cosine dissimilarity between two numeric vectors.
-//' @param x (required, numeric vector).
-//' @param y (required, numeric vector) of same length as `x`.
-//' @return numeric
-//' @examples distance_cosine_cpp(c(0.2, 0.4, 0.5), c(0.1, 0.8, 0.2))
-//' @export
-//' @family Rcpp_distance_methods
-// [[Rcpp::export]]
-double distance_cosine_cpp(NumericVector x, NumericVector y) {
+}
 
-  int length = x.size();
+// Cosine dissimilarity between two rows of length `length`
+double distance_cosine_raw(
+    const double* x,
+    const double* y,
+    int length
+) {
 
   double dotProduct = 0.0;
   double magnitudeX = 0.0;
@@ -257,19 +207,12 @@ double distance_cosine_cpp(NumericVector x, NumericVector y) {
 
 }
 
-
-//' (C++) Hamming Distance Between Two Binary Vectors
-//' @description Computes the Hamming distance between two binary vectors.
-//' @param x (required, numeric vector).
-//' @param y (required, numeric vector) of same length as `x`.
-//' @return numeric
-//' @examples distance_hamming_cpp(c(0, 1, 0, 1), c(1, 1, 0, 0))
-//' @export
-//' @family Rcpp_distance_methods
-// [[Rcpp::export]]
-double distance_hamming_cpp(NumericVector x, NumericVector y) {
-
-  int length = x.size();
+// Hamming distance between two rows of length `length`
+double distance_hamming_raw(
+    const double* x,
+    const double* y,
+    int length
+) {
 
   double dist = 0.0;
 
@@ -280,20 +223,16 @@ double distance_hamming_cpp(NumericVector x, NumericVector y) {
   }
 
   return dist;
+
 }
 
-//' (C++) Bray-Curtis Distance Between Two Vectors
-//' @description Computes the Bray-Curtis distance, suitable for species abundance data.
-//' @param x (required, numeric vector).
-//' @param y (required, numeric vector) of same length as `x`.
-//' @return numeric
-//' @examples distance_bray_curtis_cpp(x = runif(100), y = runif(100))
-//' @export
-//' @family Rcpp_distance_methods
-// [[Rcpp::export]]
-double distance_bray_curtis_cpp(NumericVector x, NumericVector y) {
+// Bray-Curtis distance between two rows of length `length`
+double distance_bray_curtis_raw(
+    const double* x,
+    const double* y,
+    int length
+) {
 
-  int length = x.size();
   double sum_min = 0.0; // Sum of minimum values
   double sum_x = 0.0;   // Sum of x values
   double sum_y = 0.0;   // Sum of y values
@@ -309,20 +248,16 @@ double distance_bray_curtis_cpp(NumericVector x, NumericVector y) {
   }
 
   return 1.0 - (2.0 * sum_min) / (sum_x + sum_y);
+
 }
 
-//' (C++) Sørensen Distance Between Two Binary Vectors
-//' @description Computes the Sørensen distance, suitable for presence/absence data.
-//' @param x (required, numeric vector).
-//' @param y (required, numeric vector) of same length as `x`.
-//' @return numeric
-//' @examples distance_sorensen_cpp(x = c(0, 1, 1, 0), y = c(1, 1, 0, 0))
-//' @export
-//' @family Rcpp_distance_methods
-// [[Rcpp::export]]
-double distance_sorensen_cpp(NumericVector x, NumericVector y) {
+// Sørensen distance between two rows of length `length`
+double distance_sorensen_raw(
+    const double* x,
+    const double* y,
+    int length
+) {
 
-  int length = x.size();
   double A = 0.0; // Shared presences
   double B = 0.0; // Present in x but not y
   double C = 0.0; // Present in y but not x
@@ -342,6 +277,199 @@ double distance_sorensen_cpp(NumericVector x, NumericVector y) {
   }
 
   return 1.0 - (2.0 * A) / (2.0 * A + B + C);
+
+}
+
+
+//' (C++) Chebyshev Distance Between Two Vectors
+//' @description Computed as: \code{max(abs(x - y))}. Cannot handle NA values.
+//' @param x (required, numeric vector).
+//' @param y (required, numeric vector) of same length as `x`.
+//' @return numeric
+//' @examples distance_chebyshev_cpp(x = runif(100), y = runif(100))
+//' @export
+//' @family Rcpp_distance_methods
+// [[Rcpp::export]]
+double distance_chebyshev_cpp(NumericVector x, NumericVector y) {
+
+  return distance_chebyshev_raw(x.begin(), y.begin(), x.size());
+
+}
+
+//' (C++) Jaccard Distance Between Two Binary Vectors
+//' @description Computes the Jaccard distance between two binary vectors.
+//' @param x (required, numeric vector).
+//' @param y (required, numeric vector) of same length as `x`.
+//' @return numeric
+//' @examples distance_jaccard_cpp(x = c(0, 1, 0, 1), y = c(1, 1, 0, 0))
+//' @export
+//' @family Rcpp_distance_methods
+// [[Rcpp::export]]
+double distance_jaccard_cpp(NumericVector x, NumericVector y) {
+
+  return distance_jaccard_raw(x.begin(), y.begin(), x.size());
+
+}
+
+
+//' (C++) Manhattan Distance Between Two Vectors
+//' @description Computed as: \code{sum(abs(x - y))}. Cannot handle NA values.
+//' @param x (required, numeric vector).
+//' @param y (required, numeric vector) of same length as `x`.
+//' @return numeric
+//' @examples distance_manhattan_cpp(x = runif(100), y = runif(100))
+//' @export
+//' @family Rcpp_distance_methods
+// [[Rcpp::export]]
+double distance_manhattan_cpp(NumericVector x, NumericVector y) {
+
+  return distance_manhattan_raw(x.begin(), y.begin(), x.size());
+
+}
+
+//' (C++) Euclidean Distance Between Two Vectors
+//' @description Computed as: \code{sqrt(sum((x - y)^2)}. Cannot handle NA values.
+//' @param x (required, numeric vector).
+//' @param y (required, numeric vector) of same length as `x`.
+//' @return numeric
+//' @examples distance_euclidean_cpp(x = runif(100), y = runif(100))
+//' @export
+//' @family Rcpp_distance_methods
+// [[Rcpp::export]]
+double distance_euclidean_cpp(NumericVector x, NumericVector y) {
+
+  return distance_euclidean_raw(x.begin(), y.begin(), x.size());
+
+}
+
+//' (C++) Hellinger Distance Between Two Vectors
+//' @description Computed as: \code{sqrt(1/2 * sum((sqrt(x) - sqrt(y))^2))}.
+//' Cannot handle NA values.
+//' @param x (required, numeric vector).
+//' @param y (required, numeric vector) of same length as `x`.
+//' @return numeric
+//' @examples distance_hellinger_cpp(x = runif(100), y = runif(100))
+//' @export
+//' @family Rcpp_distance_methods
+// [[Rcpp::export]]
+double distance_hellinger_cpp(NumericVector x, NumericVector y) {
+
+  return distance_hellinger_raw(x.begin(), y.begin(), x.size());
+
+}
+
+//' (C++) Normalized Chi Distance Between Two Vectors
+//' @description Computed as:
+//' \code{xy <- x + y}
+//' \code{y. <- y / sum(y)}
+//' \code{x. <- x / sum(x)}
+//' \code{sqrt(sum(((x. - y.)^2) / (xy / sum(xy))))}.
+//' Cannot handle NA values. When \code{x} and \code{y} have zeros in the same
+//' position, \code{NaNs} are produced. Please replace these zeros with
+//' pseudo-zeros (i.e. 0.0001) if you wish to use this distance metric.
+//' @examples distance_chi_cpp(x = runif(100), y = runif(100))
+//' @param x (required, numeric vector).
+//' @param y (required, numeric vector) of same length as `x`.
+//' @return numeric
+//' @export
+//' @family Rcpp_distance_methods
+// [[Rcpp::export]]
+double distance_chi_cpp(NumericVector x, NumericVector y) {
+
+  return distance_chi_raw(x.begin(), y.begin(), x.size());
+
+}
+
+//' (C++) Canberra Distance Between Two Binary Vectors
+//' @description Computes the Canberra distance between two binary vectors.
+//' @param x (required, numeric vector).
+//' @param y (required, numeric vector) of same length as `x`.
+//' @return numeric
+//' @examples distance_canberra_cpp(c(0, 1, 0, 1), c(1, 1, 0, 0))
+//' @export
+//' @family Rcpp_distance_methods
+// [[Rcpp::export]]
+double distance_canberra_cpp(NumericVector x, NumericVector y) {
+
+  return distance_canberra_raw(x.begin(), y.begin(), x.size());
+
+}
+
+//' (C++) Russell-Rao Distance Between Two Binary Vectors
+//' @description Computes the Russell-Rao distance between two binary vectors.
+//' @param x (required, numeric). Binary vector of 1s and 0s.
+//' @param y (required, numeric) Binary vector of 1s and 0s of same length as `x`.
+//' @return numeric
+//' @examples distance_russelrao_cpp(c(0, 1, 0, 1), c(1, 1, 0, 0))
+//' @export
+//' @family Rcpp_distance_methods
+// [[Rcpp::export]]
+double distance_russelrao_cpp(NumericVector x, NumericVector y) {
+
+  return distance_russelrao_raw(x.begin(), y.begin(), x.size());
+
+}
+
+
+//' (C++) Cosine Dissimilarity Between Two Vectors
+//' @description Computes the cosine dissimilarity between two numeric vectors.
+//' @param x (required, numeric vector).
+//' @param y (required, numeric vector) of same length as `x`.
+//' @return numeric
+//' @examples distance_cosine_cpp(c(0.2, 0.4, 0.5), c(0.1, 0.8, 0.2))
+//' @export
+//' @family Rcpp_distance_methods
+// [[Rcpp::export]]
+double distance_cosine_cpp(NumericVector x, NumericVector y) {
+
+  return distance_cosine_raw(x.begin(), y.begin(), x.size());
+
+}
+
+
+//' (C++) Hamming Distance Between Two Binary Vectors
+//' @description Computes the Hamming distance between two binary vectors.
+//' @param x (required, numeric vector).
+//' @param y (required, numeric vector) of same length as `x`.
+//' @return numeric
+//' @examples distance_hamming_cpp(c(0, 1, 0, 1), c(1, 1, 0, 0))
+//' @export
+//' @family Rcpp_distance_methods
+// [[Rcpp::export]]
+double distance_hamming_cpp(NumericVector x, NumericVector y) {
+
+  return distance_hamming_raw(x.begin(), y.begin(), x.size());
+
+}
+
+//' (C++) Bray-Curtis Distance Between Two Vectors
+//' @description Computes the Bray-Curtis distance, suitable for species abundance data.
+//' @param x (required, numeric vector).
+//' @param y (required, numeric vector) of same length as `x`.
+//' @return numeric
+//' @examples distance_bray_curtis_cpp(x = runif(100), y = runif(100))
+//' @export
+//' @family Rcpp_distance_methods
+// [[Rcpp::export]]
+double distance_bray_curtis_cpp(NumericVector x, NumericVector y) {
+
+  return distance_bray_curtis_raw(x.begin(), y.begin(), x.size());
+
+}
+
+//' (C++) Sørensen Distance Between Two Binary Vectors
+//' @description Computes the Sørensen distance, suitable for presence/absence data.
+//' @param x (required, numeric vector).
+//' @param y (required, numeric vector) of same length as `x`.
+//' @return numeric
+//' @examples distance_sorensen_cpp(x = c(0, 1, 1, 0), y = c(1, 1, 0, 0))
+//' @export
+//' @family Rcpp_distance_methods
+// [[Rcpp::export]]
+double distance_sorensen_cpp(NumericVector x, NumericVector y) {
+
+  return distance_sorensen_raw(x.begin(), y.begin(), x.size());
+
 }
 
 //define the type for the distance function
@@ -378,6 +506,166 @@ DistanceFunction select_distance_function_cpp(const std::string& distance = "euc
   }
 }
 
+// Internal function to select a distance kernel working on contiguous rows
+DistanceFunctionRaw select_distance_function_raw(const std::string& distance = "euclidean") {
+  if (distance == "manhattan" || distance.substr(0, 3) == "man") {
+    return &distance_manhattan_raw;
+  } else if (distance == "euclidean" || distance.substr(0, 3) == "euc") {
+    return &distance_euclidean_raw;
+  } else if (distance == "chebyshev" || distance.substr(0, 3) == "che") {
+    return &distance_chebyshev_raw;
+  } else if (distance == "canberra" || distance.substr(0, 3) == "can") {
+    return &distance_canberra_raw;
+  } else if (distance == "russelrao" || distance.substr(0, 3) == "rus") {
+    return &distance_russelrao_raw;
+  } else if (distance == "cosine" || distance.substr(0, 3) == "cos") {
+    return &distance_cosine_raw;
+  } else if (distance == "jaccard" || distance.substr(0, 3) == "jac") {
+    return &distance_jaccard_raw;
+  } else if (distance == "hellinger" || distance.substr(0, 3) == "hel") {
+    return &distance_hellinger_raw;
+  } else if (distance == "hamming" || distance.substr(0, 3) == "ham") {
+    return &distance_hamming_raw;
+  } else if (distance == "chi") {
+    return &distance_chi_raw;
+  } else if (distance == "bray_curtis" || distance.substr(0, 3) == "bra") {
+    return &distance_bray_curtis_raw;
+  } else if (distance == "sorensen" || distance.substr(0, 3) == "sor") {
+    return &distance_sorensen_raw;
+  } else {
+    Rcpp::stop("distantia::select_distance_function_raw(): invalid distance name or abbreviation.");
+  }
+}
+
+// Internal function to compute the distances based on absolute differences
+// ("euclidean", "manhattan", and "chebyshev") of two rows in one pass, so
+// several of them are obtained for the cost of reading the rows once. Results
+// are identical to the ones of the separate kernels.
+void distance_differences_raw(
+    const double* x,
+    const double* y,
+    int length,
+    double& euclidean,
+    double& manhattan,
+    double& chebyshev
+) {
+
+  double squares = 0.0;
+  manhattan = 0.0;
+  chebyshev = 0.0;
+
+  for (int i = 0; i < length; i++) {
+
+    double diff = x[i] - y[i];
+    double abs_diff = std::fabs(diff);
+
+    squares += diff * diff;
+    manhattan += abs_diff;
+    if (abs_diff > chebyshev) {
+      chebyshev = abs_diff;
+    }
+
+  }
+
+  euclidean = std::sqrt(squares);
+
+}
+
+// Internal function to identify the kernels computed by
+// distance_differences_raw(): 0 for "euclidean", 1 for "manhattan", 2 for
+// "chebyshev", and -1 otherwise.
+int distance_differences_index(DistanceFunctionRaw f) {
+  if (f == &distance_euclidean_raw) {
+    return 0;
+  } else if (f == &distance_manhattan_raw) {
+    return 1;
+  } else if (f == &distance_chebyshev_raw) {
+    return 2;
+  }
+  return -1;
+}
+
+// Per-variable components of additive distances
+double component_manhattan(double x, double y) {
+  return std::fabs(x - y);
+}
+
+double component_euclidean(double x, double y) {
+  return (x - y)*(x - y);
+}
+
+double component_hellinger(double x, double y) {
+  return (std::sqrt(x) - std::sqrt(y)) * (std::sqrt(x) - std::sqrt(y));
+}
+
+double component_canberra(double x, double y) {
+  double denominator = std::fabs(x) + std::fabs(y);
+  if (denominator != 0.0) {
+    return std::fabs(x - y) / denominator;
+  }
+  return 0.0;
+}
+
+double component_hamming(double x, double y) {
+  return (x != y) ? 1.0 : 0.0;
+}
+
+double component_russelrao(double x, double y) {
+  return (x == y) ? 1.0 : 0.0;
+}
+
+// Transformations of the sum of components over `length` variables
+double reduce_sum(double sum, int) {
+  return sum;
+}
+
+double reduce_sqrt(double sum, int) {
+  return std::sqrt(sum);
+}
+
+double reduce_hellinger(double sum, int) {
+  return std::sqrt(0.5 * sum);
+}
+
+double reduce_russelrao(double sum, int length) {
+  return 1.0 - (sum / length);
+}
+
+// Internal function to select the decomposition of an additive distance.
+// A distance is additive when it can be written as reduce(sum(component(x_k, y_k)))
+// over variables k, which allows computing the distance of any subset of
+// variables from the per-variable components. Returns false for distances
+// that do not decompose this way: chebyshev (maximum), cosine, jaccard,
+// bray_curtis, sorensen, and chi, which normalizes each row by the sum of
+// the variables involved.
+bool select_additive_distance(
+    const std::string& distance,
+    AdditiveDistance& additive
+){
+  if (distance == "manhattan" || distance.substr(0, 3) == "man") {
+    additive.component = &component_manhattan;
+    additive.reduce = &reduce_sum;
+  } else if (distance == "euclidean" || distance.substr(0, 3) == "euc") {
+    additive.component = &component_euclidean;
+    additive.reduce = &reduce_sqrt;
+  } else if (distance == "hellinger" || distance.substr(0, 3) == "hel") {
+    additive.component = &component_hellinger;
+    additive.reduce = &reduce_hellinger;
+  } else if (distance == "canberra" || distance.substr(0, 3) == "can") {
+    additive.component = &component_canberra;
+    additive.reduce = &reduce_sum;
+  } else if (distance == "hamming" || distance.substr(0, 3) == "ham") {
+    additive.component = &component_hamming;
+    additive.reduce = &reduce_sum;
+  } else if (distance == "russelrao" || distance.substr(0, 3) == "rus") {
+    additive.component = &component_russelrao;
+    additive.reduce = &reduce_russelrao;
+  } else {
+    return false;
+  }
+  return true;
+}
+
 
 /*** R
 #generating data
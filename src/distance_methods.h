@@ -33,6 +33,12 @@ double distance_cosine_cpp(Rcpp::NumericVector x, Rcpp::NumericVector y);
 // Cosine Hamming
 double distance_hamming_cpp(Rcpp::NumericVector x, Rcpp::NumericVector y);
 
+// Bray-Curtis Distance
+double distance_bray_curtis_cpp(Rcpp::NumericVector x, Rcpp::NumericVector y);
+
+// Sorensen Distance
+double distance_sorensen_cpp(Rcpp::NumericVector x, Rcpp::NumericVector y);
+
 
 // Define the type for the distance function
 typedef double (*DistanceFunction)(Rcpp::NumericVector, Rcpp::NumericVector);
@@ -40,4 +46,42 @@ typedef double (*DistanceFunction)(Rcpp::NumericVector, Rcpp::NumericVector);
 // Internal function to select the distance method
 DistanceFunction select_distance_function_cpp(const std::string& distance);
 
+// Distance kernels on contiguous rows of length `length`
+double distance_chebyshev_raw(const double* x, const double* y, int length);
+double distance_jaccard_raw(const double* x, const double* y, int length);
+double distance_manhattan_raw(const double* x, const double* y, int length);
+double distance_euclidean_raw(const double* x, const double* y, int length);
+double distance_hellinger_raw(const double* x, const double* y, int length);
+double distance_chi_raw(const double* x, const double* y, int length);
+double distance_canberra_raw(const double* x, const double* y, int length);
+double distance_russelrao_raw(const double* x, const double* y, int length);
+double distance_cosine_raw(const double* x, const double* y, int length);
+double distance_hamming_raw(const double* x, const double* y, int length);
+double distance_bray_curtis_raw(const double* x, const double* y, int length);
+double distance_sorensen_raw(const double* x, const double* y, int length);
+
+// Define the type for the distance kernels on contiguous rows
+typedef double (*DistanceFunctionRaw)(const double*, const double*, int);
+
+// Internal function to select the distance kernel on contiguous rows
+DistanceFunctionRaw select_distance_function_raw(const std::string& distance);
+
+// Internal function to compute "euclidean", "manhattan", and "chebyshev" in one pass
+void distance_differences_raw(const double* x, const double* y, int length, double& euclidean, double& manhattan, double& chebyshev);
+
+// Internal function to identify the kernels computed by distance_differences_raw()
+int distance_differences_index(DistanceFunctionRaw f);
+
+// Define the types for the decomposition of additive distances
+typedef double (*DistanceComponent)(double, double);
+typedef double (*DistanceReduction)(double, int);
+
+struct AdditiveDistance {
+  DistanceComponent component;
+  DistanceReduction reduce;
+};
+
+// Internal function to select the decomposition of an additive distance
+bool select_additive_distance(const std::string& distance, AdditiveDistance& additive);
+
 #endif
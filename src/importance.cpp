@@ -1,9 +1,13 @@
 #include <Rcpp.h>
 using namespace Rcpp;
 #include "distance_methods.h"
+#include "distance_matrix.h"
 #include "auto_sum.h"
-#include "cost_path.h"
+#include "cost_matrix.h"
 #include "psi.h"
+#include "column_view.h"
+#include "thread_pool.h"
+#include "alignment.h"
 
 
 // Internal function to update distances in a least-cost path.
@@ -59,14 +63,12 @@ NumericMatrix select_column_cpp(
     int column_index
     ) {
 
-  NumericMatrix x_ = Rcpp::clone(x);
-
-  int rows = x_.nrow();
+  int rows = x.nrow();
 
   NumericMatrix result(rows, 1);
 
   for (int i = 0; i < rows; ++i) {
-    result(i, 0) = x_(i, column_index);
+    result(i, 0) = x(i, column_index);
   }
 
   return result;
@@ -79,14 +81,12 @@ NumericMatrix delete_column_cpp(
     int column_index
     ) {
 
-  NumericMatrix x_ = Rcpp::clone(x);
-
-  NumericMatrix result(x_.nrow(), x_.ncol() - 1);
+  NumericMatrix result(x.nrow(), x.ncol() - 1);
 
-  for (int j = 0; j < x_.nrow(); ++j) {
-    for (int k = 0, l = 0; k < x_.ncol(); ++k) {
+  for (int j = 0; j < x.nrow(); ++j) {
+    for (int k = 0, l = 0; k < x.ncol(); ++k) {
       if (k != column_index) {
-        result(j, l) = x_(j, k);
+        result(j, l) = x(j, k);
         ++l;
       }
     }
@@ -97,6 +97,113 @@ NumericMatrix delete_column_cpp(
 }
 
 
+// Internal function to round to 8 decimal places, as done by
+// cost_path_sum_cpp() and auto_sum_cpp()
+double round_8_cpp(double x){
+  double factor = std::pow(10.0, 8);
+  return std::round(x * factor) / factor;
+}
+
+// Internal function to sum the components of an additive distance over all
+// variables but each one (`rest[k]`), from their prefix and suffix sums. Sums
+// never subtract a component from the total, so the sums without a variable
+// much larger than the others are not lost to cancellation. Does not touch
+// the R API.
+void importance_rest_sums_cpp(
+    const double* components,
+    int cols,
+    double* rest
+){
+
+  //suffix sums of the variables after each one
+  double suffix = 0.0;
+
+  for (int k = cols - 1; k >= 0; --k) {
+    rest[k] = suffix;
+    suffix += components[k];
+  }
+
+  //plus prefix sums of the variables before each one
+  double prefix = 0.0;
+
+  for (int k = 0; k < cols; ++k) {
+    rest[k] += prefix;
+    prefix += components[k];
+  }
+
+}
+
+// Internal function to sum, over pairs of rows of `a` and `b`, the distances
+// computed with each variable alone ("only with") and with all other
+// variables ("without"). Works in one pass over the per-variable components
+// of an additive distance, instead of one pass per subset of variables.
+// `a` and `b` are row-major buffers with `cols` columns, and the pairs are
+// given by the row indices `a_index` and `b_index`.
+void importance_additive_sums_cpp(
+    const std::vector<double>& a,
+    const std::vector<double>& b,
+    int cols,
+    const std::vector<int>& a_index,
+    const std::vector<int>& b_index,
+    const AdditiveDistance& additive,
+    std::vector<double>& only_with,
+    std::vector<double>& without
+){
+
+  only_with.assign(cols, 0.0);
+  without.assign(cols, 0.0);
+
+  std::vector<double> components(cols);
+  std::vector<double> rest(cols);
+
+  for (std::size_t i = 0; i < a_index.size(); ++i) {
+
+    const double* a_row = a.data() + static_cast<std::size_t>(a_index[i]) * cols;
+    const double* b_row = b.data() + static_cast<std::size_t>(b_index[i]) * cols;
+
+    for (int k = 0; k < cols; ++k) {
+      components[k] = additive.component(a_row[k], b_row[k]);
+    }
+
+    importance_rest_sums_cpp(components.data(), cols, rest.data());
+
+    for (int k = 0; k < cols; ++k) {
+      only_with[k] += additive.reduce(components[k], 1);
+      without[k] += additive.reduce(rest[k], cols - 1);
+    }
+
+  }
+
+}
+
+// Internal function to sum the distances between the rows of two column
+// views along a least-cost path (see update_path_dist_cpp() and
+// cost_path_sum_cpp()). `path_x` and `path_y` are 0-based path coordinates.
+double path_sum_view_cpp(
+    const ColumnView& x,
+    const ColumnView& y,
+    const std::vector<int>& path_x,
+    const std::vector<int>& path_y,
+    DistanceFunctionRaw f
+){
+
+  int cols = y.ncol();
+
+  std::vector<double> x_row(cols);
+  std::vector<double> y_row(cols);
+
+  double dist = 0.0;
+
+  for (std::size_t i = 0; i < path_x.size(); i++) {
+    y.row(path_y[i], y_row.data());
+    x.row(path_x[i], x_row.data());
+    dist += f(y_row.data(), x_row.data(), cols);
+  }
+
+  return round_8_cpp(dist);
+
+}
+
 //' (C++) Contribution of Individual Variables to the Dissimilarity Between Two Aligned Time Series
 //' @description Computes the contribution of individual variables to the
 //' similarity/dissimilarity between two aligned multivariate time series.
@@ -118,6 +225,11 @@ NumericMatrix delete_column_cpp(
 //' with the same number of columns and rows as 'x'.
 //' @param distance (optional, character string) distance name from the "names"
 //' column of the dataset `distances` (see `distances$name`). Default: "euclidean".
+//' @param threads (optional, integer) number of threads used to evaluate
+//' individual variables in parallel. Values smaller than one use all
+//' available cores. Distances additive by variable ("euclidean", "manhattan",
+//' "hellinger", "canberra", "hamming", and "russelrao") are decomposed in a
+//' single pass that does not use additional threads. Default: 1
 //' @return data frame
 //' @examples
 //' #simulate two regular time series
@@ -148,7 +260,8 @@ NumericMatrix delete_column_cpp(
 DataFrame importance_ls_cpp(
     NumericMatrix x,
     NumericMatrix y,
-    const std::string& distance = "euclidean"
+    const std::string& distance = "euclidean",
+    int threads = 1
 ){
 
   // Check dimensions of y and x
@@ -170,41 +283,169 @@ DataFrame importance_ls_cpp(
     distance
   );
 
-  //iterate over columns
-  for (int i = 0; i < y.ncol(); ++i){
+  AdditiveDistance additive;
 
-    //fill psi_all
-    psi_all[i] = psi_all_variables;
+  if (select_additive_distance(distance, additive)) {
 
-    //create subsets
-    NumericMatrix y_only_with = select_column_cpp(y, i);
-    NumericMatrix x_only_with = select_column_cpp(x, i);
+    //single pass over the per-variable components of the distance
+    int cols = y.ncol();
+    int rows = y.nrow();
 
-    //compute psi for the column i
-    psi_only_with[i] = psi_ls_cpp(
-      y_only_with,
+    std::vector<double> x_rows = matrix_rows_cpp(x);
+    std::vector<double> y_rows = matrix_rows_cpp(y);
+
+    //pairs of rows compared by the lock-step method
+    std::vector<int> ls_index(rows);
+    for (int i = 0; i < rows; ++i) {
+      ls_index[i] = i;
+    }
+
+    std::vector<double> ls_only_with;
+    std::vector<double> ls_without;
+
+    importance_additive_sums_cpp(
+      x_rows,
+      y_rows,
+      cols,
+      ls_index,
+      ls_index,
+      additive,
+      ls_only_with,
+      ls_without
+    );
+
+    //pairs of consecutive rows for the auto sums
+    std::vector<int> from;
+    std::vector<int> to;
+
+    auto_sum_pairs_cpp(
+      rows,
+      std::vector<int>(),
+      false,
+      from,
+      to
+    );
+
+    std::vector<double> x_only_with;
+    std::vector<double> x_without;
+
+    importance_additive_sums_cpp(
+      x_rows,
+      x_rows,
+      cols,
+      from,
+      to,
+      additive,
       x_only_with,
-      distance
+      x_without
     );
 
-    //create subsets
-    NumericMatrix y_without = delete_column_cpp(y, i);
-    NumericMatrix x_without = delete_column_cpp(x, i);
+    std::vector<double> y_only_with;
+    std::vector<double> y_without;
 
-    //compute psi without the column i
-    psi_without[i] = psi_ls_cpp(
-      y_without,
-      x_without,
-      distance
+    importance_additive_sums_cpp(
+      y_rows,
+      y_rows,
+      cols,
+      from,
+      to,
+      additive,
+      y_only_with,
+      y_without
     );
 
+    for (int i = 0; i < cols; ++i){
+
+      //psi for the column i
+      psi_only_with[i] = psi_equation_cpp(
+        ls_only_with[i],
+        round_8_cpp(round_8_cpp(x_only_with[i]) + round_8_cpp(y_only_with[i])),
+        TRUE
+      );
+
+      //psi without the column i
+      psi_without[i] = psi_equation_cpp(
+        ls_without[i],
+        round_8_cpp(round_8_cpp(x_without[i]) + round_8_cpp(y_without[i])),
+        TRUE
+      );
+
+    }
+
+  } else {
+
+    //subsets of variables are read through column views
+    DistanceFunctionRaw f = select_distance_function_raw(distance);
+
+    std::vector<int> from;
+    std::vector<int> to;
+
+    auto_sum_pairs_cpp(
+      y.nrow(),
+      std::vector<int>(),
+      false,
+      from,
+      to
+    );
+
+    const double* x_data = x.begin();
+    const double* y_data = y.begin();
+    int rows = y.nrow();
+    int cols = y.ncol();
+
+    std::vector<double> only_with(cols);
+    std::vector<double> without(cols);
+
+    //variables are evaluated in parallel, outside of the R API
+    parallel_for_cpp(cols, threads, [&](int i) {
+
+      ColumnView x_only_with = column_view_cpp(x_data, rows, cols, i, true);
+      ColumnView y_only_with = column_view_cpp(y_data, rows, cols, i, true);
+
+      //compute psi for the column i
+      only_with[i] = psi_equation_cpp(
+        distance_ls_view_cpp(y_only_with, x_only_with, f),
+        round_8_cpp(
+          auto_distance_view_cpp(y_only_with, from, to, f) +
+            auto_distance_view_cpp(x_only_with, from, to, f)
+        ),
+        TRUE
+      );
+
+      ColumnView x_without = column_view_cpp(x_data, rows, cols, i, false);
+      ColumnView y_without = column_view_cpp(y_data, rows, cols, i, false);
+
+      //compute psi without the column i
+      without[i] = psi_equation_cpp(
+        distance_ls_view_cpp(y_without, x_without, f),
+        round_8_cpp(
+          auto_distance_view_cpp(y_without, from, to, f) +
+            auto_distance_view_cpp(x_without, from, to, f)
+        ),
+        TRUE
+      );
+
+    });
+
+    for (int i = 0; i < cols; ++i){
+      psi_only_with[i] = only_with[i];
+      psi_without[i] = without[i];
+    }
+
+  }
+
+  //iterate over columns
+  for (int i = 0; i < y.ncol(); ++i){
+
+    //fill psi_all
+    psi_all[i] = psi_all_variables;
+
     //difference between only with and without
     psi_difference[i] = psi_only_with[i] - psi_without[i];
 
     //importance as percentage of psi
     importance[i] = (psi_difference[i] * 100) / psi_all_variables;
 
-
   }
 
   // Create output data frame
@@ -219,6 +460,142 @@ DataFrame importance_ls_cpp(
 
 }
 
+// Internal function to fill one matrix per variable with the sum over all
+// other variables of the components of an additive distance between the rows
+// of `y` (rows of the matrices) and `x` (columns of the matrices), as in
+// distance_matrix_cpp(). The matrix of the variable `k` starts at
+// `k * nrow(y) * nrow(x)` in `component_rest`. Sums come from prefix and
+// suffix sums of the components of each cell (see
+// importance_rest_sums_cpp()).
+void component_rest_matrix_cpp(
+    const NumericMatrix& x,
+    const NumericMatrix& y,
+    const AdditiveDistance& additive,
+    std::vector<double>& component_rest
+){
+
+  int xn = x.nrow();
+  int yn = y.nrow();
+  int cols = y.ncol();
+
+  std::size_t cells = static_cast<std::size_t>(yn) * xn;
+
+  component_rest.resize(cells * cols);
+
+  const double* x_data = x.begin();
+  const double* y_data = y.begin();
+
+  std::vector<double> components(cols);
+  std::vector<double> rest(cols);
+
+  for (int j = 0; j < xn; ++j) {
+    for (int i = 0; i < yn; ++i) {
+
+      std::size_t cell = i + static_cast<std::size_t>(j) * yn;
+
+      for (int k = 0; k < cols; ++k) {
+        components[k] = additive.component(
+          y_data[i + static_cast<std::size_t>(k) * yn],
+          x_data[j + static_cast<std::size_t>(k) * xn]
+        );
+      }
+
+      importance_rest_sums_cpp(components.data(), cols, rest.data());
+
+      for (int k = 0; k < cols; ++k) {
+        component_rest[cell + k * cells] = rest[k];
+      }
+
+    }
+  }
+
+}
+
+// Internal function to compute the psi scores only with and without the
+// variable `k` for importance_dtw_legacy_cpp(). The distance matrices of both
+// subsets follow from the components of the variable `k` and their sum over
+// all other variables (see component_rest_matrix_cpp()), and are aligned together as
+// two interleaved problems in `dist_batch` and `cost_batch`. `x` and `y` are
+// the column-major data of the time series. Does not touch the R API.
+void importance_legacy_additive_cpp(
+    const double* x,
+    int xn,
+    const double* y,
+    int yn,
+    int cols,
+    const std::vector<double>& component_rest,
+    int k,
+    const AdditiveDistance& additive,
+    DistanceFunctionRaw f,
+    bool diagonal,
+    bool weighted,
+    bool ignore_blocks,
+    double bandwidth,
+    std::vector<double>& dist_batch,
+    std::vector<double>& cost_batch,
+    double& only_with,
+    double& without
+){
+
+  std::size_t cells = static_cast<std::size_t>(yn) * xn;
+  dist_batch.resize(cells * 2);
+  cost_batch.resize(cells * 2);
+
+  const double* x_column = x + static_cast<std::size_t>(k) * xn;
+  const double* y_column = y + static_cast<std::size_t>(k) * yn;
+
+  for (int j = 0; j < xn; ++j) {
+    for (int i = 0; i < yn; ++i) {
+
+      std::size_t cell = i + static_cast<std::size_t>(j) * yn;
+
+      double component = additive.component(y_column[i], x_column[j]);
+
+      dist_batch[cell * 2] = additive.reduce(component, 1);
+      dist_batch[cell * 2 + 1] = additive.reduce(component_rest[cell + k * cells], cols - 1);
+
+    }
+  }
+
+  StepPattern pattern = cost_matrix_step_pattern(diagonal, weighted);
+
+  cost_matrix_batch(
+    dist_batch.data(),
+    cost_batch.data(),
+    yn,
+    xn,
+    2,
+    pattern
+  );
+
+  only_with = psi_dtw_lane_cpp(
+    dist_batch.data(),
+    cost_batch.data(),
+    2,
+    0,
+    column_view_cpp(x, xn, cols, k, true),
+    column_view_cpp(y, yn, cols, k, true),
+    f,
+    pattern,
+    ignore_blocks,
+    bandwidth
+  );
+
+  without = psi_dtw_lane_cpp(
+    dist_batch.data(),
+    cost_batch.data(),
+    2,
+    1,
+    column_view_cpp(x, xn, cols, k, false),
+    column_view_cpp(y, yn, cols, k, false),
+    f,
+    pattern,
+    ignore_blocks,
+    bandwidth
+  );
+
+}
+
 //' (C++) Contribution of Individual Variables to the Dissimilarity Between Two Time Series (Legacy Version)
 //' @description Computes the contribution of individual variables to the
 //' similarity/dissimilarity between two irregular multivariate time series.
@@ -254,6 +631,9 @@ DataFrame importance_ls_cpp(
 //' both sides of the diagonal used to constrain the least cost path. Expressed
 //' as a fraction of the number of matrix rows and columns. Unrestricted by default.
 //' Default: 1
+//' @param threads (optional, integer) number of threads used to evaluate
+//' individual variables in parallel. Values smaller than one use all
+//' available cores. Default: 1
 //' @return data frame
 //' @examples
 //' #simulate two regular time series
@@ -289,7 +669,8 @@ DataFrame importance_dtw_legacy_cpp(
     bool diagonal = false,
     bool weighted = true,
     bool ignore_blocks = false,
-    double bandwidth = 1
+    double bandwidth = 1,
+    int threads = 1
 ){
 
   //vectors to store results
@@ -310,41 +691,104 @@ DataFrame importance_dtw_legacy_cpp(
     bandwidth
   );
 
-  //iterate over columns
-  for (int i = 0; i < y.ncol(); ++i){
+  DistanceFunctionRaw f = select_distance_function_raw(distance);
 
-    //fill psi_all
-    psi_all[i] = psi_all_variables;
+  //distance matrices of additive distances are derived from the
+  //per-variable components, computed once for all variables
+  AdditiveDistance additive;
+  bool use_components = y.ncol() > 1 && select_additive_distance(distance, additive);
 
-    //create subsets
-    NumericMatrix x_only_with = select_column_cpp(x, i);
-    NumericMatrix y_only_with = select_column_cpp(y, i);
+  std::vector<double> component_rest;
 
-    //compute psi only with the column i
-    psi_only_with[i] = psi_dtw_cpp(
-      x_only_with,
-      y_only_with,
-      distance,
-      diagonal,
-      weighted,
-      ignore_blocks,
-      bandwidth
+  if (use_components) {
+    component_rest_matrix_cpp(
+      x,
+      y,
+      additive,
+      component_rest
     );
+  }
 
-    //create subsets
-    NumericMatrix x_without = delete_column_cpp(x, i);
-    NumericMatrix y_without = delete_column_cpp(y, i);
-
-    //compute psi without the column i
-    psi_without[i] = psi_dtw_cpp(
-      x_without,
-      y_without,
-      distance,
-      diagonal,
-      weighted,
-      ignore_blocks,
-      bandwidth
-    );
+  const double* x_data = x.begin();
+  const double* y_data = y.begin();
+  int xn = x.nrow();
+  int yn = y.nrow();
+  int cols = y.ncol();
+
+  std::vector<double> only_with(cols);
+  std::vector<double> without(cols);
+
+  //variables are evaluated in parallel, outside of the R API
+  parallel_for_cpp(cols, threads, [&](int i) {
+
+    if (use_components) {
+
+      std::vector<double> dist_batch;
+      std::vector<double> cost_batch;
+
+      importance_legacy_additive_cpp(
+        x_data,
+        xn,
+        y_data,
+        yn,
+        cols,
+        component_rest,
+        i,
+        additive,
+        f,
+        diagonal,
+        weighted,
+        ignore_blocks,
+        bandwidth,
+        dist_batch,
+        cost_batch,
+        only_with[i],
+        without[i]
+      );
+
+    } else {
+
+      //subsets of variables read through column views
+      ColumnView x_only_with = column_view_cpp(x_data, xn, cols, i, true);
+      ColumnView y_only_with = column_view_cpp(y_data, yn, cols, i, true);
+
+      //compute psi only with the column i
+      only_with[i] = psi_dtw_view_cpp(
+        x_only_with,
+        y_only_with,
+        f,
+        diagonal,
+        weighted,
+        ignore_blocks,
+        bandwidth
+      );
+
+      ColumnView x_without = column_view_cpp(x_data, xn, cols, i, false);
+      ColumnView y_without = column_view_cpp(y_data, yn, cols, i, false);
+
+      //compute psi without the column i
+      without[i] = psi_dtw_view_cpp(
+        x_without,
+        y_without,
+        f,
+        diagonal,
+        weighted,
+        ignore_blocks,
+        bandwidth
+      );
+
+    }
+
+  });
+
+  //iterate over columns
+  for (int i = 0; i < cols; ++i){
+
+    //fill psi_all
+    psi_all[i] = psi_all_variables;
+
+    psi_only_with[i] = only_with[i];
+    psi_without[i] = without[i];
 
     //difference between only with and without
     psi_difference[i] = psi_only_with[i] - psi_without[i];
@@ -401,6 +845,11 @@ DataFrame importance_dtw_legacy_cpp(
 //' both sides of the diagonal used to constrain the least cost path. Expressed
 //' as a fraction of the number of matrix rows and columns. Unrestricted by default.
 //' Default: 1
+//' @param threads (optional, integer) number of threads used to evaluate
+//' individual variables in parallel. Values smaller than one use all
+//' available cores. Distances additive by variable ("euclidean", "manhattan",
+//' "hellinger", "canberra", "hamming", and "russelrao") are decomposed in a
+//' single pass that does not use additional threads. Default: 1
 //' @return data frame
 //' @examples
 //' #simulate two regular time series
@@ -436,7 +885,8 @@ DataFrame importance_dtw_cpp(
     bool diagonal = true,
     bool weighted = true,
     bool ignore_blocks = false,
-    double bandwidth = 1
+    double bandwidth = 1,
+    int threads = 1
 ){
 
   //vectors to store results
@@ -447,25 +897,39 @@ DataFrame importance_dtw_cpp(
   NumericVector importance(y.ncol());
 
 
-  //compute psi with all variables
-  DataFrame path = cost_path_cpp(
-    x,
-    y,
-    distance,
-    diagonal,
-    weighted,
+  int cols = y.ncol();
+
+  DistanceFunctionRaw f = select_distance_function_raw(distance);
+
+  std::vector<double> x_rows = matrix_rows_cpp(x);
+  std::vector<double> y_rows = matrix_rows_cpp(y);
+
+  //compute psi with all variables, with the least cost path kept in C++
+  Alignment alignment;
+
+  alignment_compute_cpp(
+    x_rows.data(),
+    x.nrow(),
+    y_rows.data(),
+    y.nrow(),
+    cols,
+    f,
+    cost_matrix_step_pattern(diagonal, weighted),
+    NULL,
     ignore_blocks,
-    bandwidth
+    bandwidth,
+    alignment
   );
 
-  double path_sum = cost_path_sum_cpp(path);
+  double path_sum = cost_path_sum_raw(alignment.path);
 
   // auto sum of distances to normalize cost path sum
-  double xy_sum = auto_sum_cpp(
-    x,
-    y,
-    path,
-    distance,
+  double xy_sum = alignment_auto_sum_raw(
+    alignment,
+    x_rows.data(),
+    y_rows.data(),
+    cols,
+    f,
     ignore_blocks
   );
 
@@ -476,72 +940,173 @@ DataFrame importance_dtw_cpp(
     diagonal
   );
 
-  //iterate over columns
-  for (int i = 0; i < y.ncol(); ++i){
+  //pairs of rows in the least-cost path (0-based)
+  const std::vector<int>& path_x_index = alignment.path.x;
+  const std::vector<int>& path_y_index = alignment.path.y;
 
-    //fill psi_all
-    psi_all[i] = psi_all_variables;
+  AdditiveDistance additive;
 
-    //create subsets
-    NumericMatrix x_only_with = select_column_cpp(x, i);
-    NumericMatrix y_only_with = select_column_cpp(y, i);
+  if (select_additive_distance(distance, additive)) {
 
-    //update dist in path
-    DataFrame path_only_with = update_path_dist_cpp(
-      x_only_with,
-      y_only_with,
-      path,
-      distance
+    //single pass over the per-variable components of the distance
+    std::vector<double> path_only_with;
+    std::vector<double> path_without;
+
+    importance_additive_sums_cpp(
+      y_rows,
+      x_rows,
+      cols,
+      path_y_index,
+      path_x_index,
+      additive,
+      path_only_with,
+      path_without
+    );
+
+    //pairs of consecutive rows for the auto sums
+    std::vector<int> from;
+    std::vector<int> to;
+
+    auto_sum_pairs_cpp(
+      x.nrow(),
+      path_x_index,
+      ignore_blocks,
+      from,
+      to
     );
 
-    double path_only_with_sum = cost_path_sum_cpp(path_only_with);
+    std::vector<double> x_only_with;
+    std::vector<double> x_without;
 
-    //compute autosum of y_only_with and x_only_with
-    double xy_sum_only_with = auto_sum_cpp(
+    importance_additive_sums_cpp(
+      x_rows,
+      x_rows,
+      cols,
+      from,
+      to,
+      additive,
       x_only_with,
-      y_only_with,
-      path,
-      distance,
-      ignore_blocks
+      x_without
     );
 
-    //compute psi
-    psi_only_with[i] = psi_equation_cpp(
-      path_only_with_sum,
-      xy_sum_only_with,
-      diagonal
+    auto_sum_pairs_cpp(
+      y.nrow(),
+      path_y_index,
+      ignore_blocks,
+      from,
+      to
     );
 
-    //create subsets
-    NumericMatrix y_without = delete_column_cpp(y, i);
-    NumericMatrix x_without = delete_column_cpp(x, i);
+    std::vector<double> y_only_with;
+    std::vector<double> y_without;
 
-    //update dist in path
-    DataFrame path_without = update_path_dist_cpp(
-      x_without,
-      y_without,
-      path,
-      distance
+    importance_additive_sums_cpp(
+      y_rows,
+      y_rows,
+      cols,
+      from,
+      to,
+      additive,
+      y_only_with,
+      y_without
     );
 
-    double path_without_sum = cost_path_sum_cpp(path_without);
+    for (int i = 0; i < cols; ++i){
+
+      //psi only with the column i
+      psi_only_with[i] = psi_equation_cpp(
+        round_8_cpp(path_only_with[i]),
+        round_8_cpp(round_8_cpp(x_only_with[i]) + round_8_cpp(y_only_with[i])),
+        diagonal
+      );
+
+      //psi without the column i
+      psi_without[i] = psi_equation_cpp(
+        round_8_cpp(path_without[i]),
+        round_8_cpp(round_8_cpp(x_without[i]) + round_8_cpp(y_without[i])),
+        diagonal
+      );
 
-    //compute autosum of y_without and x_without
-    double xy_sum_without = auto_sum_cpp(
-      x_without,
-      y_without,
-      path,
-      distance,
-      ignore_blocks
+    }
+
+  } else {
+
+    //subsets of variables are read through column views
+    //pairs of consecutive rows for the auto sums
+    std::vector<int> x_from;
+    std::vector<int> x_to;
+
+    auto_sum_pairs_cpp(
+      x.nrow(),
+      path_x_index,
+      ignore_blocks,
+      x_from,
+      x_to
     );
 
-    //compute psi
-    psi_without[i] = psi_equation_cpp(
-      path_without_sum,
-      xy_sum_without,
-      diagonal
+    std::vector<int> y_from;
+    std::vector<int> y_to;
+
+    auto_sum_pairs_cpp(
+      y.nrow(),
+      path_y_index,
+      ignore_blocks,
+      y_from,
+      y_to
     );
 
+    const double* x_data = x.begin();
+    const double* y_data = y.begin();
+    int xn = x.nrow();
+    int yn = y.nrow();
+
+    std::vector<double> only_with(cols);
+    std::vector<double> without(cols);
+
+    //variables are evaluated in parallel, outside of the R API
+    parallel_for_cpp(cols, threads, [&](int i) {
+
+      ColumnView x_only_with = column_view_cpp(x_data, xn, cols, i, true);
+      ColumnView y_only_with = column_view_cpp(y_data, yn, cols, i, true);
+
+      //compute psi only with the column i
+      only_with[i] = psi_equation_cpp(
+        path_sum_view_cpp(x_only_with, y_only_with, path_x_index, path_y_index, f),
+        round_8_cpp(
+          auto_distance_view_cpp(x_only_with, x_from, x_to, f) +
+            auto_distance_view_cpp(y_only_with, y_from, y_to, f)
+        ),
+        diagonal
+      );
+
+      ColumnView x_without = column_view_cpp(x_data, xn, cols, i, false);
+      ColumnView y_without = column_view_cpp(y_data, yn, cols, i, false);
+
+      //compute psi without the column i
+      without[i] = psi_equation_cpp(
+        path_sum_view_cpp(x_without, y_without, path_x_index, path_y_index, f),
+        round_8_cpp(
+          auto_distance_view_cpp(x_without, x_from, x_to, f) +
+            auto_distance_view_cpp(y_without, y_from, y_to, f)
+        ),
+        diagonal
+      );
+
+    });
+
+    for (int i = 0; i < cols; ++i){
+      psi_only_with[i] = only_with[i];
+      psi_without[i] = without[i];
+    }
+
+  }
+
+  //iterate over columns
+  for (int i = 0; i < y.ncol(); ++i){
+
+    //fill psi_all
+    psi_all[i] = psi_all_variables;
+
     //difference between only with and without
     psi_difference[i] = psi_only_with[i] - psi_without[i];
 
@@ -26,7 +26,8 @@ Rcpp::NumericMatrix delete_column_cpp(
 Rcpp::DataFrame importance_ls_cpp(
     Rcpp::NumericMatrix a,
     Rcpp::NumericMatrix b,
-    const std::string& distance = "euclidean"
+    const std::string& distance = "euclidean",
+    int threads = 1
 );
 
 Rcpp::DataFrame importance_dtw_legacy_cpp(
@@ -36,7 +37,8 @@ Rcpp::DataFrame importance_dtw_legacy_cpp(
     bool diagonal = false,
     bool weighted = false,
     bool ignore_blocks = false,
-    double bandwidth = 1
+    double bandwidth = 1,
+    int threads = 1
 );
 
 Rcpp::DataFrame importance_dtw_cpp(
@@ -46,7 +48,8 @@ Rcpp::DataFrame importance_dtw_cpp(
     bool diagonal = false,
     bool weighted = false,
     bool ignore_blocks = false,
-    double bandwidth = 1
+    double bandwidth = 1,
+    int threads = 1
   );
 
 #endif // IMPORTANCE_H
@@ -0,0 +1,158 @@
+#include <Rcpp.h>
+#include <algorithm>
+#include <cmath>
+#include <utility>
+#include <vector>
+#include "thread_pool.h"
+using namespace Rcpp;
+
+// Internal function to find the `k` nearest neighbors of each of `n` points
+// with `dims` coordinates stored as a row-major buffer, by brute force, with
+// ties going to the lowest index. Points are distributed over threads.
+// Writes the 0-based indices of the neighbors of point `i` to the positions
+// [i * k, (i + 1) * k) of `out`. Does not touch the R API.
+void knn_pairs_raw(
+    const double* points,
+    int n,
+    int dims,
+    int k,
+    int threads,
+    std::vector<int>& out
+){
+
+  out.assign(static_cast<std::size_t>(n) * k, -1);
+
+  int workers = resolve_threads_cpp(threads, std::max(1, n));
+  std::vector<std::vector<std::pair<double, int>>> candidates(workers);
+
+  parallel_for_worker_cpp(
+    n,
+    threads,
+    [&](int i, int w) {
+
+      std::vector<std::pair<double, int>>& candidate = candidates[w];
+      candidate.clear();
+
+      const double* p_i = points + static_cast<std::size_t>(i) * dims;
+
+      for (int j = 0; j < n; ++j) {
+
+        if (j == i) {
+          continue;
+        }
+
+        const double* p_j = points + static_cast<std::size_t>(j) * dims;
+        double d = 0.0;
+
+        for (int c = 0; c < dims; ++c) {
+          double diff = p_i[c] - p_j[c];
+          d += diff * diff;
+        }
+
+        candidate.emplace_back(d, j);
+
+      }
+
+      std::partial_sort(candidate.begin(), candidate.begin() + k, candidate.end());
+
+      for (int m = 0; m < k; ++m) {
+        out[static_cast<std::size_t>(i) * k + m] = candidate[m].second;
+      }
+
+    }
+  );
+
+}
+
+//' (C++) Pairs of K-Nearest Neighbors in Space
+//' @description Finds the `k` nearest neighbors of each point of a matrix of
+//' coordinates (euclidean distance, ties to the lowest row) and returns the
+//' unique pairs of neighbors, to restrict [distantia()] to pairs of time
+//' series close in space (see its argument `pairs`) instead of computing all
+//' pairs. Each point is paired with its `k` neighbors, so the number of pairs
+//' is at most `k` times the number of points. Points are distributed over
+//' `threads` threads.
+//' @param xy (required, numeric matrix) coordinates of the points, one row per
+//' point, usually in the same order as the time series of a time series list,
+//' for example, from `sf::st_coordinates(sf::st_centroid(x))`.
+//' @param k (optional, integer) number of neighbors of each point. Default: 1
+//' @param threads (optional, integer) number of threads. Values smaller than
+//' one use all available cores. Default: 1
+//' @return integer matrix with the columns "x" and "y", with the row indices of
+//' the points of each pair (x < y), ordered by "x" and "y".
+//' @examples
+//' xy <- cbind(
+//'   x = c(0, 1, 2, 10, 11),
+//'   y = c(0, 0, 0, 10, 10)
+//' )
+//'
+//' knn_pairs_cpp(
+//'   xy = xy,
+//'   k = 1
+//' )
+//' @family Rcpp_matrix
+//' @export
+// [[Rcpp::export]]
+IntegerMatrix knn_pairs_cpp(
+    NumericMatrix xy,
+    int k = 1,
+    int threads = 1
+){
+
+  int n = xy.nrow();
+  int dims = xy.ncol();
+
+  if (k < 1 || k >= n) {
+    Rcpp::stop("distantia::knn_pairs_cpp(): argument 'k' must be an integer between 1 and the number of rows of 'xy' minus one.");
+  }
+
+  std::vector<double> points(static_cast<std::size_t>(n) * dims);
+
+  for (int i = 0; i < n; ++i) {
+    for (int c = 0; c < dims; ++c) {
+      double v = xy(i, c);
+      if (!std::isfinite(v)) {
+        Rcpp::stop("distantia::knn_pairs_cpp(): argument 'xy' must not have NA or infinite values.");
+      }
+      points[static_cast<std::size_t>(i) * dims + c] = v;
+    }
+  }
+
+  std::vector<int> neighbors;
+
+  knn_pairs_raw(
+    points.data(),
+    n,
+    dims,
+    k,
+    threads,
+    neighbors
+  );
+
+  //unique pairs with the lowest index first
+  std::vector<std::pair<int, int>> pairs;
+  pairs.reserve(neighbors.size());
+
+  for (int i = 0; i < n; ++i) {
+    for (int m = 0; m < k; ++m) {
+      int j = neighbors[static_cast<std::size_t>(i) * k + m];
+      pairs.emplace_back(std::min(i, j), std::max(i, j));
+    }
+  }
+
+  std::sort(pairs.begin(), pairs.end());
+  pairs.erase(std::unique(pairs.begin(), pairs.end()), pairs.end());
+
+  int n_pairs = static_cast<int>(pairs.size());
+  IntegerMatrix out(n_pairs, 2);
+
+  for (int p = 0; p < n_pairs; ++p) {
+    out(p, 0) = pairs[p].first + 1;
+    out(p, 1) = pairs[p].second + 1;
+  }
+
+  colnames(out) = CharacterVector::create("x", "y");
+
+  return out;
+
+}
@@ -0,0 +1,332 @@
+#include <Rcpp.h>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+#include "thread_pool.h"
+using namespace Rcpp;
+
+// Windows of a multivariate time series stored column by column, centered on
+// the mean of each column to keep sliding dot products accurate, with the
+// mean and inverse standard deviation of each column in each window.
+struct ProfileSeries {
+  std::vector<double> values;
+  std::vector<double> mean;
+  std::vector<double> inv_sd;
+  int nrow;
+  int ncol;
+  int windows;
+};
+
+// Internal function to prepare the windows of `width` rows of a time series
+// for matrix_profile_raw(). The mean and standard deviation of each window are
+// computed in two passes over its rows. Windows of constant columns get an
+// inverse standard deviation of zero.
+ProfileSeries matrix_profile_series(
+    NumericMatrix x,
+    int width
+){
+
+  ProfileSeries s;
+  s.nrow = x.nrow();
+  s.ncol = x.ncol();
+  s.windows = s.nrow - width + 1;
+  s.values.resize(static_cast<std::size_t>(s.nrow) * s.ncol);
+  s.mean.resize(static_cast<std::size_t>(s.windows) * s.ncol);
+  s.inv_sd.resize(static_cast<std::size_t>(s.windows) * s.ncol);
+
+  for (int c = 0; c < s.ncol; ++c) {
+
+    double* v = s.values.data() + static_cast<std::size_t>(c) * s.nrow;
+
+    double center = 0.0;
+    for (int t = 0; t < s.nrow; ++t) {
+      center += x(t, c);
+    }
+    center /= s.nrow;
+
+    for (int t = 0; t < s.nrow; ++t) {
+      v[t] = x(t, c) - center;
+    }
+
+    //window statistics in two passes over each window, so rounding errors
+    //do not accumulate along the time series
+    for (int k = 0; k < s.windows; ++k) {
+
+      const double* w = v + k;
+
+      double mean = 0.0;
+      for (int t = 0; t < width; ++t) {
+        mean += w[t];
+      }
+      mean /= width;
+
+      double var = 0.0;
+      for (int t = 0; t < width; ++t) {
+        double e = w[t] - mean;
+        var += e * e;
+      }
+      var /= width;
+
+      //variance below rounding error of the window values
+      double tolerance = 1e-12 * (var + mean * mean);
+
+      s.mean[static_cast<std::size_t>(c) * s.windows + k] = mean;
+      s.inv_sd[static_cast<std::size_t>(c) * s.windows + k] = var > tolerance ? 1.0 / std::sqrt(var) : 0.0;
+
+    }
+
+  }
+
+  return s;
+
+}
+
+// Internal function to compute the matrix profile of the windows of `a`
+// against the windows of `b` (same object for self-joins). Cells of the
+// distance matrix between windows are visited diagonal by diagonal, as in
+// SCRIMP, so the dot product between two windows is updated from the one of
+// the previous cell of the diagonal in constant time per column, and computed
+// again from the windows every `max(width, 128)` cells (as SCRIMP++ and
+// STUMPY do) to bound the accumulated rounding error. Diagonals are
+// independent tasks distributed over threads. In self-joins,
+// only diagonals above the exclusion zone are visited, and each cell updates
+// the profiles of both windows. Writes the squared z-normalized euclidean
+// distance to the nearest window of `b`, and its index, to `profile` and
+// `index` (-1 when there is none). Ties go to the lowest index. Does not
+// touch the R API.
+void matrix_profile_raw(
+    const ProfileSeries& a,
+    const ProfileSeries& b,
+    int width,
+    bool self_join,
+    int exclusion,
+    int threads,
+    std::vector<double>& profile,
+    std::vector<int>& index
+){
+
+  int na = a.windows;
+  int nb = b.windows;
+  int cols = a.ncol;
+
+  //diagonals as offsets k = j - i between windows i of a and j of b
+  int k_first = self_join ? exclusion + 1 : -(na - 1);
+  int k_last = nb - 1;
+  int diagonals = std::max(0, k_last - k_first + 1);
+
+  int workers = resolve_threads_cpp(threads, std::max(1, diagonals));
+
+  //steps between exact dot products; each one costs `width` operations, so
+  //they add at most one operation per step
+  int refresh = std::max(width, 128);
+
+  double infinity = std::numeric_limits<double>::infinity();
+  std::vector<std::vector<double>> worker_profile(workers, std::vector<double>(na, infinity));
+  std::vector<std::vector<int>> worker_index(workers, std::vector<int>(na, -1));
+  std::vector<std::vector<double>> worker_dot(workers, std::vector<double>(cols));
+
+  auto update = [](double d, int j, double& best, int& best_j) {
+    if (d < best || (d == best && j < best_j)) {
+      best = d;
+      best_j = j;
+    }
+  };
+
+  parallel_for_worker_cpp(
+    diagonals,
+    threads,
+    [&](int task, int w) {
+
+      int k = k_first + task;
+      int i = k < 0 ? -k : 0;
+      int j = i + k;
+      int steps = std::min(na - i, nb - j);
+
+      double* dot = worker_dot[w].data();
+      double* p = worker_profile[w].data();
+      int* idx = worker_index[w].data();
+
+      for (int step = 0; step < steps; ++step, ++i, ++j) {
+
+        if (step % refresh == 0) {
+
+          //exact dot products, computed again at regular intervals so the
+          //rounding errors of the updates do not accumulate along the diagonal
+          for (int c = 0; c < cols; ++c) {
+            const double* va = a.values.data() + static_cast<std::size_t>(c) * a.nrow + i;
+            const double* vb = b.values.data() + static_cast<std::size_t>(c) * b.nrow + j;
+            double s = 0.0;
+            for (int t = 0; t < width; ++t) {
+              s += va[t] * vb[t];
+            }
+            dot[c] = s;
+          }
+
+        } else {
+
+          for (int c = 0; c < cols; ++c) {
+            const double* va = a.values.data() + static_cast<std::size_t>(c) * a.nrow;
+            const double* vb = b.values.data() + static_cast<std::size_t>(c) * b.nrow;
+            dot[c] += va[i + width - 1] * vb[j + width - 1] - va[i - 1] * vb[j - 1];
+          }
+
+        }
+
+        //squared z-normalized euclidean distance, summed over columns
+        double d = 0.0;
+
+        for (int c = 0; c < cols; ++c) {
+
+          std::size_t ca = static_cast<std::size_t>(c) * na + i;
+          std::size_t cb = static_cast<std::size_t>(c) * nb + j;
+          double sa = a.inv_sd[ca];
+          double sb = b.inv_sd[cb];
+          double r;
+
+          if (sa == 0.0 || sb == 0.0) {
+            //constant windows are identical to each other and uncorrelated to the rest
+            r = (sa == 0.0 && sb == 0.0) ? 1.0 : 0.0;
+          } else {
+            r = (dot[c] - width * a.mean[ca] * b.mean[cb]) * sa * sb / width;
+            r = std::min(1.0, std::max(-1.0, r));
+          }
+
+          d += 2.0 * width * (1.0 - r);
+
+        }
+
+        update(d, j, p[i], idx[i]);
+
+        if (self_join) {
+          update(d, i, p[j], idx[j]);
+        }
+
+      }
+
+    }
+  );
+
+  profile.assign(na, infinity);
+  index.assign(na, -1);
+
+  for (int w = 0; w < workers; ++w) {
+    for (int i = 0; i < na; ++i) {
+      if (worker_index[w][i] >= 0) {
+        update(worker_profile[w][i], worker_index[w][i], profile[i], index[i]);
+      }
+    }
+  }
+
+}
+
+//' (C++) Matrix Profile of Time Series Windows
+//' @description Computes the matrix profile of a time series `x`: for each
+//' window of `width` rows of `x`, the z-normalized euclidean distance to its
+//' most similar window of `y`, or of `x` itself when `y` is NULL, together
+//' with the position of that window. In self-joins, windows starting up to a
+//' quarter of `width` rows away from the one being compared (the exclusion
+//' zone) are skipped, to avoid trivial matches. Windows are z-normalized
+//' column by column, and the distances of the columns of multivariate time
+//' series are added up before the square root.
+//'
+//' Low values of the profile point to motifs (windows repeated elsewhere in
+//' the time series), and high values to discords (windows unlike any other).
+//' Distances are computed diagonal by diagonal of the matrix of distances
+//' between windows, updating the dot products between windows from the ones
+//' of the previous cell of the diagonal (as in the SCRIMP algorithm), so the
+//' cost is proportional to the number of pairs of windows regardless of
+//' `width`, and diagonals are distributed over `threads` threads. Dot products
+//' are computed again from the windows at regular intervals along each
+//' diagonal, and the mean and standard deviation of each window are computed
+//' in two passes over its rows, so rounding errors do not accumulate along
+//' long time series.
+//' @param x (required, numeric matrix) time series.
+//' @param width (required, integer) number of rows of each window.
+//' @param y (optional, numeric matrix) time series to search for the windows
+//' of `x`, with the same number of columns as `x`. If NULL, windows of `x`
+//' are compared with each other. Default: NULL
+//' @param threads (optional, integer) number of threads. Values smaller than
+//' one use all available cores. Default: 1
+//' @return data frame with one row per window of `x` and the columns "start"
+//' (first row of the window), "distance" (matrix profile), and "index" (first
+//' row of the most similar window). Windows without valid matches have NA
+//' distance and index.
+//' @examples
+//' x <- zoo_simulate(
+//'   rows = 1000,
+//'   cols = 1,
+//'   seasons = 10,
+//'   seed = 1
+//' )
+//'
+//' mp <- matrix_profile_cpp(
+//'   x = x,
+//'   width = 50
+//' )
+//'
+//' #motif
+//' mp[which.min(mp$distance), ]
+//'
+//' #discord
+//' mp[which.max(mp$distance), ]
+//' @family Rcpp_dissimilarity_analysis
+//' @export
+// [[Rcpp::export]]
+DataFrame matrix_profile_cpp(
+    NumericMatrix x,
+    int width,
+    Nullable<NumericMatrix> y = R_NilValue,
+    int threads = 1
+){
+
+  bool self_join = y.isNull();
+  NumericMatrix y_matrix = self_join ? x : NumericMatrix(y.get());
+
+  if (x.ncol() != y_matrix.ncol()) {
+    Rcpp::stop("distantia::matrix_profile_cpp(): 'x' and 'y' must have the same number of columns.");
+  }
+
+  if (width < 2 || width > x.nrow() || width > y_matrix.nrow()) {
+    Rcpp::stop("distantia::matrix_profile_cpp(): argument 'width' must be an integer between 2 and the number of rows of 'x' and 'y'.");
+  }
+
+  ProfileSeries a = matrix_profile_series(x, width);
+  ProfileSeries b = self_join ? ProfileSeries() : matrix_profile_series(y_matrix, width);
+
+  std::vector<double> profile;
+  std::vector<int> index;
+
+  matrix_profile_raw(
+    a,
+    self_join ? a : b,
+    width,
+    self_join,
+    static_cast<int>(std::ceil(width / 4.0)),
+    threads,
+    profile,
+    index
+  );
+
+  IntegerVector out_start(a.windows);
+  NumericVector out_distance(a.windows);
+  IntegerVector out_index(a.windows);
+
+  for (int i = 0; i < a.windows; ++i) {
+    out_start[i] = i + 1;
+    if (index[i] < 0) {
+      out_distance[i] = NA_REAL;
+      out_index[i] = NA_INTEGER;
+    } else {
+      out_distance[i] = std::sqrt(std::max(0.0, profile[i]));
+      out_index[i] = index[i] + 1;
+    }
+  }
+
+  return DataFrame::create(
+    _["start"] = out_start,
+    _["distance"] = out_distance,
+    _["index"] = out_index
+  );
+
+}
@@ -2,9 +2,13 @@
 #include <cmath>
 #include "distance_methods.h"
 #include "distance_matrix.h"
-#include "cost_path.h"
+#include "cost_matrix.h"
+#include "cost_path_raw.h"
 #include "auto_sum.h"
 #include "permute.h"
+#include "column_view.h"
+#include "alignment.h"
+#include "cost_window.h"
 using namespace Rcpp;
 
 
@@ -231,6 +235,29 @@ NumericVector psi_null_ls_cpp(
 //' @param bandwidth (required, numeric) Size of the Sakoe-Chiba band at
 //' both sides of the diagonal used to constrain the least cost path. Expressed
 //' as a fraction of the number of matrix rows and columns. Unrestricted by default.
+//' Only restricts the traceback of the least cost path, and the cost matrix is
+//' still computed in full (see `window_size`).
+//' @param step_pattern (optional, character string) step pattern of the cost
+//' matrix and the least cost path (see [cost_path_cpp()]), one of
+//' "orthogonal", "symmetric1", "weighted", "symmetric2", or "asymmetric". If
+//' NULL, defined by `diagonal` and `weighted`, which are otherwise ignored.
+//' The psi equation for paths with diagonal steps is used for all step
+//' patterns but "orthogonal" (see [psi_equation_cpp()]). Default: NULL
+//' @param window (optional, character string) cells of the cost matrix
+//' computed by dynamic programming, one of "none", "sakoe_chiba", "itakura",
+//' or "envelope" (see [cost_path_cpp()]). Default: "none"
+//' @param window_size (optional, numeric) size of the Sakoe-Chiba window at
+//' both sides of the diagonal, as a fraction of the number of rows of `y`.
+//' Unlike `bandwidth`, it restricts the cost matrix itself, and distances of
+//' cells outside of the window are not computed. Only relevant when `window` is
+//' "sakoe_chiba". Default: 1
+//' @param slope (optional, numeric) maximum slope of the Itakura
+//' parallelogram, higher than one. Only relevant when `window` is "itakura".
+//' Default: 2
+//' @param lower (optional, integer vector) first row of `y` admissible for
+//' each row of `x`. Only relevant when `window` is "envelope". Default: NULL
+//' @param upper (optional, integer vector) last row of `y` admissible for each
+//' row of `x`. Only relevant when `window` is "envelope". Default: NULL
 //' @return numeric
 //' @family Rcpp_dissimilarity_analysis
 //' @export
@@ -242,41 +269,233 @@ double psi_dtw_cpp(
     bool diagonal = true,
     bool weighted = true,
     bool ignore_blocks = false,
-    double bandwidth = 1
+    double bandwidth = 1,
+    Nullable<CharacterVector> step_pattern = R_NilValue,
+    const std::string& window = "none",
+    double window_size = 1,
+    double slope = 2,
+    Nullable<IntegerVector> lower = R_NilValue,
+    Nullable<IntegerVector> upper = R_NilValue
 ){
 
-  DataFrame path = cost_path_cpp(
-    x,
-    y,
-    distance,
+  if (x.ncol() != y.ncol()) {
+    Rcpp::stop("distantia::psi_dtw_cpp(): 'x' and 'y' must have the same number of columns.");
+  }
+
+  DistanceFunctionRaw f = select_distance_function_raw(distance);
+
+  StepPattern pattern = cost_window_step_pattern_cpp(
+    step_pattern,
     diagonal,
     weighted,
+    "psi_dtw_cpp"
+  );
+
+  CostWindow cells;
+
+  const CostWindow* restricted = cost_window_build_cpp(
+    window,
+    x.nrow(),
+    y.nrow(),
+    window_size,
+    slope,
+    lower,
+    upper,
+    "psi_dtw_cpp",
+    cells
+  );
+
+  std::vector<double> x_rows = matrix_rows_cpp(x);
+  std::vector<double> y_rows = matrix_rows_cpp(y);
+
+  //least cost path kept in C++ (see alignment_cpp())
+  Alignment alignment;
+
+  bool found = alignment_compute_cpp(
+    x_rows.data(),
+    x.nrow(),
+    y_rows.data(),
+    y.nrow(),
+    x.ncol(),
+    f,
+    pattern,
+    restricted,
     ignore_blocks,
-    bandwidth
+    bandwidth,
+    alignment
   );
 
-  double a = cost_path_sum_cpp(path);
+  if (!found) {
+    Rcpp::stop("distantia::psi_dtw_cpp(): there is no path from the first to the last cell of the cost matrix within the window with this step pattern.");
+  }
 
-  double b = auto_sum_cpp(
-    x,
-    y,
-    path,
-    distance,
+  double a = cost_path_sum_raw(alignment.path);
+
+  double b = alignment_auto_sum_raw(
+    alignment,
+    x_rows.data(),
+    y_rows.data(),
+    x.ncol(),
+    f,
     ignore_blocks
   );
 
   double psi_score = psi_equation_cpp(
     a,
     b,
-    diagonal
+    pattern != step_orthogonal
   );
 
   return psi_score;
 
 }
 
+// Internal function to compute the psi score of two column views from their
+// distance and cost matrices, stored in the lane `lane` of buffers with
+// `lanes` interleaved problems (see cost_matrix_batch()). Does not touch the
+// R API.
+double psi_dtw_lane_cpp(
+    const double* dist_matrix,
+    const double* cost_matrix,
+    int lanes,
+    int lane,
+    const ColumnView& x,
+    const ColumnView& y,
+    DistanceFunctionRaw f,
+    StepPattern pattern,
+    bool ignore_blocks,
+    double bandwidth
+){
+
+  int xn = x.nrow;
+  int yn = y.nrow;
+
+  CostPath path;
+
+  cost_path_raw(
+    dist_matrix,
+    cost_matrix,
+    yn,
+    xn,
+    pattern,
+    bandwidth,
+    path,
+    lanes,
+    lane
+  );
+
+  if (ignore_blocks) {
+    cost_path_trim_raw(path);
+  }
+
+  double a = cost_path_sum_raw(path);
+
+  //auto sum of distances to normalize cost path sum
+  std::vector<int> from;
+  std::vector<int> to;
+
+  auto_sum_pairs_cpp(xn, path.x, ignore_blocks, from, to);
+  double x_sum = auto_distance_view_cpp(x, from, to, f);
+
+  auto_sum_pairs_cpp(yn, path.y, ignore_blocks, from, to);
+  double y_sum = auto_distance_view_cpp(y, from, to, f);
+
+  // rounding to 8 decimal places
+  double factor = std::pow(10.0, 8);
+  double b = std::round((x_sum + y_sum) * factor) / factor;
+
+  return psi_equation_cpp(
+    a,
+    b,
+    pattern != step_orthogonal
+  );
+
+}
+
+// Internal function to compute the psi score of two column views with
+// dynamic time warping (see psi_dtw_cpp()). Used to compare subsets of
+// variables without copying the time series. Does not touch the R API.
+double psi_dtw_view_cpp(
+    const ColumnView& x,
+    const ColumnView& y,
+    DistanceFunctionRaw f,
+    bool diagonal,
+    bool weighted,
+    bool ignore_blocks,
+    double bandwidth
+){
+
+  StepPattern pattern = cost_matrix_step_pattern(diagonal, weighted);
+
+  int xn = x.nrow;
+  int yn = y.nrow;
 
+  std::size_t cells = static_cast<std::size_t>(yn) * xn;
+  std::vector<double> dist_matrix(cells);
+  std::vector<double> cost_matrix(cells);
 
+  //distances read from the memory of the views
+  distance_matrix_view_raw(
+    x,
+    y,
+    f,
+    dist_matrix.data()
+  );
+
+  cost_matrix_batch(
+    dist_matrix.data(),
+    cost_matrix.data(),
+    yn,
+    xn,
+    1,
+    pattern
+  );
+
+  return psi_dtw_lane_cpp(
+    dist_matrix.data(),
+    cost_matrix.data(),
+    1,
+    0,
+    x,
+    y,
+    f,
+    pattern,
+    ignore_blocks,
+    bandwidth
+  );
+
+}
+
+
+
+// Internal function to define how many permutations are aligned at once by
+// psi_null_dtw_cpp(). Up to eight problems are interleaved, as long as each
+// batch buffer stays below 4M cells (32MB).
+int null_batch_lanes(
+    int yn,
+    int xn
+){
+
+  const std::size_t max_lanes = 8;
+  const std::size_t max_cells = 4194304;
+
+  std::size_t cells = static_cast<std::size_t>(yn) * xn;
+
+  if (cells == 0) {
+    return 1;
+  }
+
+  std::size_t lanes = max_cells / cells;
+
+  if (lanes < 1) {
+    lanes = 1;
+  } else if (lanes > max_lanes) {
+    lanes = max_lanes;
+  }
+
+  return static_cast<int>(lanes);
+
+}
 
 
 //' (C++) Null Distribution of Dissimilarity Scores of Two Time Series
@@ -312,6 +531,22 @@ double psi_dtw_cpp(
 //' restricted permutation. A block size of 3 indicates that a row can only be permuted
 //' within a block of 3 adjacent rows. Minimum value is 2. Default: 3.
 //' @param seed (optional, integer) initial random seed to use for replicability. Default: 1
+//' @param step_pattern (optional, character string) step pattern of the cost
+//' matrix and the least cost path (see [psi_dtw_cpp()]). If NULL, defined by
+//' `diagonal` and `weighted`. Default: NULL
+//' @param window (optional, character string) cells of the cost matrix
+//' computed by dynamic programming, one of "none", "sakoe_chiba", "itakura",
+//' or "envelope" (see [cost_path_cpp()]). The same window is used for all
+//' permutations. Default: "none"
+//' @param window_size (optional, numeric) size of the Sakoe-Chiba window at
+//' both sides of the diagonal, as a fraction of the number of rows of `y`
+//' (see [psi_dtw_cpp()]). Default: 1
+//' @param slope (optional, numeric) maximum slope of the Itakura
+//' parallelogram, higher than one. Default: 2
+//' @param lower (optional, integer vector) first row of `y` admissible for
+//' each row of `x` when `window` is "envelope". Default: NULL
+//' @param upper (optional, integer vector) last row of `y` admissible for each
+//' row of `x` when `window` is "envelope". Default: NULL
 //' @return numeric vector
 //' @family Rcpp_dissimilarity_analysis
 //' @export
@@ -327,7 +562,13 @@ NumericVector psi_null_dtw_cpp(
     int repetitions = 100,
     const std::string& permutation = "restricted_by_row",
     int block_size = 3,
-    int seed = 1
+    int seed = 1,
+    Nullable<CharacterVector> step_pattern = R_NilValue,
+    const std::string& window = "none",
+    double window_size = 1,
+    double slope = 2,
+    Nullable<IntegerVector> lower = R_NilValue,
+    Nullable<IntegerVector> upper = R_NilValue
 ){
 
   // Select permutation function
@@ -343,25 +584,64 @@ NumericVector psi_null_dtw_cpp(
   // Create numeric vector to store Psi distances
   NumericVector psi_null(repetitions);
 
-  // Create cost path
-  DataFrame path = cost_path_cpp(
-    x,
-    y,
-    distance,
+  DistanceFunctionRaw f = select_distance_function_raw(distance);
+
+  StepPattern pattern = cost_window_step_pattern_cpp(
+    step_pattern,
     diagonal,
     weighted,
+    "psi_null_dtw_cpp"
+  );
+
+  CostWindow cells;
+
+  const CostWindow* restricted = cost_window_build_cpp(
+    window,
+    x.nrow(),
+    y.nrow(),
+    window_size,
+    slope,
+    lower,
+    upper,
+    "psi_null_dtw_cpp",
+    cells
+  );
+
+  std::vector<double> x_rows = matrix_rows_cpp(x);
+  std::vector<double> y_rows = matrix_rows_cpp(y);
+
+  // Create cost path, kept in C++ (see alignment_cpp())
+  Alignment alignment;
+
+  bool found = alignment_compute_cpp(
+    x_rows.data(),
+    x.nrow(),
+    y_rows.data(),
+    y.nrow(),
+    x.ncol(),
+    f,
+    pattern,
+    restricted,
     ignore_blocks,
-    bandwidth
+    bandwidth,
+    alignment
   );
 
-  double a = cost_path_sum_cpp(path);
+  // Reachability only depends on the shape of the cost matrix, the window,
+  // and the step pattern, so it holds for all permutations
+  if (!found) {
+    Rcpp::stop("distantia::psi_null_dtw_cpp(): there is no path from the first to the last cell of the cost matrix within the window with this step pattern.");
+  }
+
+  double a = cost_path_sum_raw(alignment.path);
 
   // auto sum of distances to normalize cost path sum
-  double b = auto_sum_cpp(
-    x,
-    y,
-    path,
-    distance,
+  double b = alignment_auto_sum_raw(
+    alignment,
+    x_rows.data(),
+    y_rows.data(),
+    x.ncol(),
+    f,
     ignore_blocks
   );
 
@@ -369,7 +649,7 @@ NumericVector psi_null_dtw_cpp(
   psi_null[0] = psi_equation_cpp(
     a,
     b,
-    diagonal
+    pattern != step_orthogonal
   );
 
   // Use the integer seed value
@@ -377,42 +657,98 @@ NumericVector psi_null_dtw_cpp(
   Function set_seed = base_env["set.seed"];
   set_seed(seed);
 
-  // Iterate over repetitions
-  for (int i = 1; i < repetitions; ++i) {
-
-    // Permute matrix x
-    NumericMatrix permuted_x = permutation_function(
-      x,
-      block_size,
-      seed + i
-    );
-
-    // Permute matrix y
-    NumericMatrix permuted_y = permutation_function(
-      y,
-      block_size,
-      seed + i + 1
-    );
-
-    // Create cost path of permuted sequences
-    DataFrame permuted_path = cost_path_cpp(
-      permuted_x,
-      permuted_y,
-      distance,
-      diagonal,
-      weighted,
-      ignore_blocks,
-      bandwidth
+  // Permutations have the same shape, and are aligned in batches
+  // of `lanes` problems advancing together through the cost matrix
+
+  int xn = x.nrow();
+  int yn = y.nrow();
+  int lanes = null_batch_lanes(yn, xn);
+
+  std::size_t batch_size = static_cast<std::size_t>(yn) * xn * lanes;
+  std::vector<double> dist_batch(batch_size, 0.0);
+  std::vector<double> cost_batch(batch_size, 0.0);
+
+  CostPath permuted_path;
+
+  // Iterate over batches of repetitions
+  for (int i = 1; i < repetitions; i += lanes) {
+
+    int batch = std::min(lanes, repetitions - i);
+
+    for (int k = 0; k < batch; ++k) {
+
+      // Permute matrix x
+      NumericMatrix permuted_x = permutation_function(
+        x,
+        block_size,
+        seed + i + k
+      );
+
+      // Permute matrix y
+      NumericMatrix permuted_y = permutation_function(
+        y,
+        block_size,
+        seed + i + k + 1
+      );
+
+      std::vector<double> permuted_x_rows = matrix_rows_cpp(permuted_x);
+      std::vector<double> permuted_y_rows = matrix_rows_cpp(permuted_y);
+
+      // Distance matrix of the permuted sequences in lane k
+      distance_matrix_raw(
+        permuted_x_rows.data(),
+        xn,
+        permuted_y_rows.data(),
+        yn,
+        x.ncol(),
+        f,
+        dist_batch.data() + k,
+        lanes,
+        restricted
+      );
+
+    }
+
+    // Cost matrices of all permuted sequences in the batch
+    cost_matrix_batch(
+      dist_batch.data(),
+      cost_batch.data(),
+      yn,
+      xn,
+      lanes,
+      pattern,
+      restricted
     );
 
-    double a_permuted = cost_path_sum_cpp(permuted_path);
-
-    // Compute Psi distance on permuted matrices and store result
-    psi_null[i] = psi_equation_cpp(
-      a_permuted,
-      b,
-      diagonal
-    );
+    for (int k = 0; k < batch; ++k) {
+
+      // Create cost path of permuted sequences
+      cost_path_raw(
+        dist_batch.data(),
+        cost_batch.data(),
+        yn,
+        xn,
+        pattern,
+        bandwidth,
+        permuted_path,
+        lanes,
+        k
+      );
+
+      if (ignore_blocks) {
+        cost_path_trim_raw(permuted_path);
+      }
+
+      double a_permuted = cost_path_sum_raw(permuted_path);
+
+      // Compute Psi distance on permuted matrices and store result
+      psi_null[i + k] = psi_equation_cpp(
+        a_permuted,
+        b,
+        pattern != step_orthogonal
+      );
+
+    }
 
   }
 
@@ -2,6 +2,9 @@
 #define PSI_H
 
 #include <Rcpp.h>
+#include "distance_methods.h"
+#include "column_view.h"
+#include "cost_matrix.h"
 
 // Forward declarations of functions
 
@@ -34,7 +37,13 @@ double psi_dtw_cpp(
     bool diagonal = false,
     bool weighted = false,
     bool ignore_blocks = false,
-    double bandwidth = 1
+    double bandwidth = 1,
+    Rcpp::Nullable<Rcpp::CharacterVector> step_pattern = R_NilValue,
+    const std::string& window = "none",
+    double window_size = 1,
+    double slope = 2,
+    Rcpp::Nullable<Rcpp::IntegerVector> lower = R_NilValue,
+    Rcpp::Nullable<Rcpp::IntegerVector> upper = R_NilValue
 );
 
 Rcpp::NumericVector psi_null_dtw_cpp(
@@ -51,4 +60,27 @@ Rcpp::NumericVector psi_null_dtw_cpp(
     int repetitions = 100
 );
 
+double psi_dtw_lane_cpp(
+    const double* dist_matrix,
+    const double* cost_matrix,
+    int lanes,
+    int lane,
+    const ColumnView& x,
+    const ColumnView& y,
+    DistanceFunctionRaw f,
+    StepPattern pattern,
+    bool ignore_blocks,
+    double bandwidth
+);
+
+double psi_dtw_view_cpp(
+    const ColumnView& x,
+    const ColumnView& y,
+    DistanceFunctionRaw f,
+    bool diagonal,
+    bool weighted,
+    bool ignore_blocks,
+    double bandwidth
+);
+
 #endif  // PSI_H
@@ -0,0 +1,516 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+#include "cost_matrix.h"
+#include "distance_methods.h"
+#include "psi_tsl.h"
+#include "psi_bounds.h"
+
+// Internal function to clamp the bandwidth as in cost_path_raw().
+static double psi_bound_bandwidth(
+    double bandwidth
+){
+
+  if (bandwidth < 0.0) {
+    return 0.0;
+  } else if (bandwidth > 1.0) {
+    return 1.0;
+  }
+
+  return bandwidth;
+
+}
+
+// Internal functions with the Sakoe-Chiba band of cost_path_raw(): rows of
+// the column `x` of a distance matrix a least cost path can visit.
+static int psi_bound_y_min(
+    int x,
+    int d_rows,
+    int d_cols,
+    double bandwidth
+){
+  return std::max(0, static_cast<int>(static_cast<long long>(x) * d_rows / d_cols - bandwidth * d_rows));
+}
+
+static int psi_bound_y_max(
+    int x,
+    int d_rows,
+    int d_cols,
+    double bandwidth
+){
+  return std::min(d_rows - 1, static_cast<int>(static_cast<long long>(x) * d_rows / d_cols + bandwidth * d_rows));
+}
+
+// Internal function to check whether every least cost path traced by
+// cost_path_raw() on a distance matrix of `d_rows` by `d_cols` reaches its
+// first cell. The path starts at the last cell and moves to a neighbor within
+// the Sakoe-Chiba band until there is none, so it reaches the first cell when
+// every cell of the band (and the last cell) has a neighbor within the band.
+// Always true for unrestricted paths. Lower bounds of psi based on the cells
+// a path must visit are only valid for complete paths. With a window of the
+// cost matrix (`window` not NULL), the path moves along cells of finite cost,
+// each one with a predecessor of finite cost, so it is complete when the
+// traceback is unrestricted and the last cell is reachable (otherwise no path
+// is traced at all). Never true for the step pattern "asymmetric", which
+// skips samples of `y`. Does not touch the R API.
+bool psi_dtw_path_complete_cpp(
+    int d_rows,
+    int d_cols,
+    StepPattern pattern,
+    const CostWindow* window,
+    double bandwidth
+){
+
+  if (pattern == step_asymmetric) {
+    return false;
+  }
+
+  bool diagonal = pattern != step_orthogonal;
+
+  bandwidth = psi_bound_bandwidth(bandwidth);
+
+  if (bandwidth >= 1.0) {
+    return true;
+  }
+
+  if (window != NULL) {
+    return false;
+  }
+
+  auto in_band = [&](int x, int y) -> bool {
+    return x >= 0 && y >= 0 &&
+      y >= psi_bound_y_min(x, d_rows, d_cols, bandwidth) &&
+      y <= psi_bound_y_max(x, d_rows, d_cols, bandwidth);
+  };
+
+  auto has_neighbor = [&](int x, int y) -> bool {
+    return (diagonal && in_band(x - 1, y - 1)) ||
+      in_band(x, y - 1) ||
+      in_band(x - 1, y);
+  };
+
+  if ((d_rows > 1 || d_cols > 1) && !has_neighbor(d_cols - 1, d_rows - 1)) {
+    return false;
+  }
+
+  for (int x = 0; x < d_cols; ++x) {
+
+    int y_last = psi_bound_y_max(x, d_rows, d_cols, bandwidth);
+
+    for (int y = psi_bound_y_min(x, d_rows, d_cols, bandwidth); y <= y_last; ++y) {
+      if ((x > 0 || y > 0) && !has_neighbor(x, y)) {
+        return false;
+      }
+    }
+
+  }
+
+  return true;
+
+}
+
+// Internal function to compute, for each index k, the minimum and maximum of
+// each column of the samples lo[k] to hi[k] of a row-major time series, where
+// lo and hi do not decrease with k. Each column is swept once with monotonic
+// queues. Results are written to `lower` and `upper` as k * ncol + column.
+static void psi_bound_envelope(
+    const double* rows,
+    int ncol,
+    const std::vector<int>& lo,
+    const std::vector<int>& hi,
+    std::vector<double>& lower,
+    std::vector<double>& upper
+){
+
+  int n = static_cast<int>(lo.size());
+
+  lower.resize(static_cast<std::size_t>(n) * ncol);
+  upper.resize(static_cast<std::size_t>(n) * ncol);
+
+  std::vector<int> q_min(hi.empty() ? 0 : hi.back() + 1);
+  std::vector<int> q_max(q_min.size());
+
+  for (int v = 0; v < ncol; ++v) {
+
+    auto value = [&](int i) -> double {
+      return rows[static_cast<std::size_t>(i) * ncol + v];
+    };
+
+    int min_head = 0, min_tail = 0;
+    int max_head = 0, max_tail = 0;
+    int next = 0;
+
+    for (int k = 0; k < n; ++k) {
+
+      for (; next <= hi[k]; ++next) {
+
+        while (min_tail > min_head && value(q_min[min_tail - 1]) >= value(next)) {
+          --min_tail;
+        }
+        q_min[min_tail++] = next;
+
+        while (max_tail > max_head && value(q_max[max_tail - 1]) <= value(next)) {
+          --max_tail;
+        }
+        q_max[max_tail++] = next;
+
+      }
+
+      while (q_min[min_head] < lo[k]) {
+        ++min_head;
+      }
+
+      while (q_max[max_head] < lo[k]) {
+        ++max_head;
+      }
+
+      lower[static_cast<std::size_t>(k) * ncol + v] = value(q_min[min_head]);
+      upper[static_cast<std::size_t>(k) * ncol + v] = value(q_max[max_head]);
+
+    }
+
+  }
+
+}
+
+// Internal function to sum the distances between each sample of a row-major
+// time series and the box given by `lower` and `upper` at the same index.
+// Each distance is a lower bound of the distance between the sample and any
+// sample within the box for the distances in distance_differences_index():
+// the absolute difference of each column is at least its gap to the box.
+static double psi_bound_box_sum(
+    const double* rows,
+    int nrow,
+    int ncol,
+    int f_index,
+    const std::vector<double>& lower,
+    const std::vector<double>& upper
+){
+
+  double sum = 0.0;
+
+  for (int i = 0; i < nrow; ++i) {
+
+    const double* sample = rows + static_cast<std::size_t>(i) * ncol;
+    const double* l = lower.data() + static_cast<std::size_t>(i) * ncol;
+    const double* u = upper.data() + static_cast<std::size_t>(i) * ncol;
+
+    double dist = 0.0;
+
+    for (int v = 0; v < ncol; ++v) {
+
+      double gap = 0.0;
+
+      if (sample[v] < l[v]) {
+        gap = l[v] - sample[v];
+      } else if (sample[v] > u[v]) {
+        gap = sample[v] - u[v];
+      }
+
+      if (f_index == 0) {
+        dist += gap * gap;
+      } else if (f_index == 1) {
+        dist += gap;
+      } else if (gap > dist) {
+        dist = gap;
+      }
+
+    }
+
+    sum += f_index == 0 ? std::sqrt(dist) : dist;
+
+  }
+
+  return sum;
+
+}
+
+// Internal function to compute a lower bound of the psi score of two time
+// series with dynamic time warping (see psi_dtw_cpp()) without computing
+// their distance matrix. The sum of distances of the least cost path is
+// bounded from below by:
+// - the distance between the last samples, because the path always starts
+//   at the last cell of the distance matrix;
+// - plus the distance between the first samples when the path is complete
+//   (see psi_dtw_path_complete_cpp()), as in LB_Kim;
+// - when the path is complete and the distance is euclidean, manhattan, or
+//   chebyshev, the sum of the distances of each sample of one time series to
+//   the envelope of the samples of the other time series within the
+//   Sakoe-Chiba band, because a complete path visits every sample of both
+//   time series at least once, as in LB_Keogh. Both directions are computed.
+// `b` is the sum of the auto distances of both time series, as in
+// psi_dtw_sweep_cpp(). The bound is slightly lowered to account for the
+// rounding of the path sum and psi score, so it never exceeds the psi
+// score computed by psi_dtw_cpp(). Returns infinity when `b` is zero,
+// because the psi score is then NA. Does not touch the R API.
+double psi_dtw_lower_bound_cpp(
+    const TslSeries& x,
+    const TslSeries& y,
+    DistanceFunctionRaw f,
+    bool complete,
+    double bandwidth,
+    double b,
+    bool diagonal,
+    PsiBoundScratch& scratch
+){
+
+  if (b == 0.0) {
+    return std::numeric_limits<double>::infinity();
+  }
+
+  int xn = x.nrow;
+  int yn = y.nrow;
+  int ncol = x.ncol;
+
+  const double* x_rows = x.data();
+  const double* y_rows = y.data();
+
+  //last cell
+  double a = f(
+    x_rows + static_cast<std::size_t>(xn - 1) * ncol,
+    y_rows + static_cast<std::size_t>(yn - 1) * ncol,
+    ncol
+  );
+
+  if (complete) {
+
+    //first cell (LB_Kim)
+    if (xn > 1 || yn > 1) {
+      a += f(x_rows, y_rows, ncol);
+    }
+
+    int f_index = distance_differences_index(f);
+
+    if (f_index >= 0) {
+
+      bandwidth = psi_bound_bandwidth(bandwidth);
+
+      //envelope of y over the band of each sample of x (columns of the
+      //distance matrix); the last sample also reaches the last cell
+      scratch.lo.resize(xn);
+      scratch.hi.resize(xn);
+
+      for (int c = 0; c < xn; ++c) {
+        scratch.lo[c] = psi_bound_y_min(c, yn, xn, bandwidth);
+        scratch.hi[c] = psi_bound_y_max(c, yn, xn, bandwidth);
+      }
+
+      scratch.hi[xn - 1] = yn - 1;
+
+      psi_bound_envelope(y_rows, ncol, scratch.lo, scratch.hi, scratch.lower, scratch.upper);
+
+      a = std::max(
+        a,
+        psi_bound_box_sum(x_rows, xn, ncol, f_index, scratch.lower, scratch.upper)
+      );
+
+      //envelope of x over the band of each sample of y (rows of the
+      //distance matrix): the columns whose band contains the row
+      scratch.lo.resize(yn);
+      scratch.hi.resize(yn);
+
+      int c_lo = 0;
+      int c_hi = -1;
+      bool valid = true;
+
+      for (int r = 0; r < yn; ++r) {
+
+        while (c_lo < xn && psi_bound_y_max(c_lo, yn, xn, bandwidth) < r) {
+          ++c_lo;
+        }
+
+        while (c_hi + 1 < xn && psi_bound_y_min(c_hi + 1, yn, xn, bandwidth) <= r) {
+          ++c_hi;
+        }
+
+        scratch.lo[r] = c_lo;
+        scratch.hi[r] = c_hi;
+
+      }
+
+      scratch.lo[yn - 1] = std::min(scratch.lo[yn - 1], xn - 1);
+      scratch.hi[yn - 1] = xn - 1;
+
+      for (int r = 0; r < yn; ++r) {
+        if (scratch.lo[r] > scratch.hi[r]) {
+          valid = false;
+          break;
+        }
+      }
+
+      if (valid) {
+
+        psi_bound_envelope(x_rows, ncol, scratch.lo, scratch.hi, scratch.lower, scratch.upper);
+
+        a = std::max(
+          a,
+          psi_bound_box_sum(y_rows, yn, ncol, f_index, scratch.lower, scratch.upper)
+        );
+
+      }
+
+    }
+
+  }
+
+  //margin for rounding of the path sum and psi score
+  a = a * (1.0 - 1e-12) - 1e-8;
+
+  double psi = ((2.0 * a) / b) - 1.0;
+
+  if (diagonal) {
+    psi = psi + 1.0;
+  }
+
+  return psi - 1e-8;
+
+}
+
+// Internal function to compute the highest value of the last cell of the cost
+// matrix (before adding the cost of the first cell) of two time series whose
+// psi score can still be lower than or equal to `max_psi`, when their least
+// cost path is complete (see psi_dtw_path_complete_cpp()). Moving backwards
+// along the path, the cost matrix decreases by at most the distance of each
+// cell times the highest weight of the steps of `pattern`, so the sum of
+// distances of the path is at least the cost of its last cell divided by that
+// weight. Includes a margin for the rounding of the path sum and psi score.
+// `b` is the sum of the auto distances of both time series. Does not touch
+// the R API.
+double psi_dtw_max_cost_cpp(
+    double max_psi,
+    double b,
+    StepPattern pattern
+){
+
+  double psi = max_psi + 1e-8 + 1.0;
+
+  if (pattern != step_orthogonal) {
+    psi = psi - 1.0;
+  }
+
+  double a = (psi * b / 2.0) * (1.0 + 1e-12) + 1e-8;
+
+  double weight = cost_matrix_step_max_weight(pattern);
+
+  return a * weight * (1.0 + 1e-12);
+
+}
+
+// Internal function to compute the distance and cost matrices of two time
+// series column by column (see distance_matrix_raw() and cost_matrix_batch(),
+// with the same values), abandoning as soon as the lowest cost of a column,
+// plus a lower bound of the cost of the remaining columns, is higher than
+// `max_cost`. Every path from the first cell of the cost matrix to the last
+// one crosses every column, and each cell adds at least its distance to the
+// cost (step weights are never lower than one), so the cost of the last cell
+// is at least the lowest cost of any column plus the lowest distance of each
+// of the next columns. For the distances in distance_differences_index(),
+// the lowest distance of a column is bounded by the distance between its
+// sample of `x` and the envelope of all samples of `y`; otherwise, by zero.
+// Only the cells of `window` are computed (NULL for the full matrix, see
+// cost_matrix_batch()). When `dist_ready` is true, `dist_matrix` already
+// holds the distances of those cells. Returns false when abandoned, leaving
+// both matrices incomplete. Does not touch the R API.
+bool psi_dtw_cost_abandon_cpp(
+    const TslSeries& x,
+    const TslSeries& y,
+    DistanceFunctionRaw f,
+    StepPattern pattern,
+    const CostWindow* window,
+    double max_cost,
+    bool dist_ready,
+    double* dist_matrix,
+    double* cost_matrix,
+    PsiBoundScratch& scratch
+){
+
+  int xn = x.nrow;
+  int yn = y.nrow;
+  int ncol = x.ncol;
+
+  const double* x_rows = x.data();
+  const double* y_rows = y.data();
+
+  //lower bound of the cost of the columns after each column
+  std::vector<double>& remaining = scratch.remaining;
+  remaining.assign(xn, 0.0);
+
+  int f_index = distance_differences_index(f);
+
+  if (f_index >= 0 && xn > 1) {
+
+    scratch.lo.assign(1, 0);
+    scratch.hi.assign(1, yn - 1);
+
+    psi_bound_envelope(y_rows, ncol, scratch.lo, scratch.hi, scratch.lower, scratch.upper);
+
+    //the envelope of each sample of x is the one of all samples of y
+    scratch.lower.resize(static_cast<std::size_t>(xn) * ncol);
+    scratch.upper.resize(static_cast<std::size_t>(xn) * ncol);
+
+    for (int j = 1; j < xn; ++j) {
+      std::copy(scratch.lower.begin(), scratch.lower.begin() + ncol, scratch.lower.begin() + static_cast<std::size_t>(j) * ncol);
+      std::copy(scratch.upper.begin(), scratch.upper.begin() + ncol, scratch.upper.begin() + static_cast<std::size_t>(j) * ncol);
+    }
+
+    for (int j = xn - 2; j >= 0; --j) {
+      remaining[j] = remaining[j + 1] + psi_bound_box_sum(
+        x_rows + static_cast<std::size_t>(j + 1) * ncol,
+        1,
+        ncol,
+        f_index,
+        scratch.lower,
+        scratch.upper
+      );
+    }
+
+  }
+
+  for (int j = 0; j < xn; ++j) {
+
+    double* d_j = dist_matrix + static_cast<std::size_t>(j) * yn;
+    double* m_j = cost_matrix + static_cast<std::size_t>(j) * yn;
+
+    int lo = window == NULL ? 0 : window->lo[j];
+    int hi = window == NULL ? yn - 1 : window->hi[j];
+
+    if (!dist_ready) {
+
+      const double* x_row = x_rows + static_cast<std::size_t>(j) * ncol;
+
+      for (int i = lo; i <= hi; ++i) {
+        d_j[i] = f(y_rows + static_cast<std::size_t>(i) * ncol, x_row, ncol);
+      }
+
+    }
+
+    cost_matrix_column(
+      d_j,
+      j == 0 ? NULL : m_j - yn,
+      m_j,
+      yn,
+      1,
+      pattern,
+      lo,
+      hi
+    );
+
+    double column_min = m_j[lo];
+
+    for (int i = lo + 1; i <= hi; ++i) {
+      column_min = m_j[i] < column_min ? m_j[i] : column_min;
+    }
+
+    if (column_min + remaining[j] > max_cost) {
+      return false;
+    }
+
+  }
+
+  // Adjusting the last cell to include the return cost to the starting point
+  cost_matrix_return(cost_matrix, yn, xn, 1);
+
+  return true;
+
+}
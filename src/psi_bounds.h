@@ -0,0 +1,47 @@
+#ifndef PSI_BOUNDS_H
+#define PSI_BOUNDS_H
+
+#include <vector>
+#include "distance_methods.h"
+#include "cost_matrix.h"
+#include "psi_tsl.h"
+
+bool psi_dtw_path_complete_cpp(
+    int d_rows,
+    int d_cols,
+    StepPattern pattern,
+    const CostWindow* window,
+    double bandwidth
+);
+
+double psi_dtw_lower_bound_cpp(
+    const TslSeries& x,
+    const TslSeries& y,
+    DistanceFunctionRaw f,
+    bool complete,
+    double bandwidth,
+    double b,
+    bool diagonal,
+    PsiBoundScratch& scratch
+);
+
+double psi_dtw_max_cost_cpp(
+    double max_psi,
+    double b,
+    StepPattern pattern
+);
+
+bool psi_dtw_cost_abandon_cpp(
+    const TslSeries& x,
+    const TslSeries& y,
+    DistanceFunctionRaw f,
+    StepPattern pattern,
+    const CostWindow* window,
+    double max_cost,
+    bool dist_ready,
+    double* dist_matrix,
+    double* cost_matrix,
+    PsiBoundScratch& scratch
+);
+
+#endif // PSI_BOUNDS_H
@@ -0,0 +1,315 @@
+#include <Rcpp.h>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <mutex>
+#include <utility>
+#include "distance_methods.h"
+#include "distance_matrix.h"
+#include "psi_tsl.h"
+#include "psi_bounds.h"
+#include "alignment_cache.h"
+#include "thread_pool.h"
+using namespace Rcpp;
+
+//' (C++) Most Similar Time Series to a Query via Dynamic Time Warping
+//' @description Finds the `k` time series of a list with the lowest psi
+//' dissimilarity scores with a query time series, with the results of
+//' [psi_dtw_cpp()] (query as `x`, time series of the list as `y`), without
+//' aligning the query with every time series of the list.
+//'
+//' A cheap lower bound of the psi score of each time series is computed
+//' first, from the distances between the first and last samples of both time
+//' series (as in LB_Kim) and, for the distances "euclidean", "manhattan", and
+//' "chebyshev", from the distances between each sample and the envelope of
+//' the other time series within the Sakoe-Chiba band (as in LB_Keogh). Time
+//' series are then aligned in order of increasing lower bound, and the search
+//' stops once the lower bound of the next time series is higher than the
+//' k-th lowest psi score found so far, because none of the remaining time
+//' series can enter the result. The result is the same as ranking the psi
+//' scores of all time series, ties included. Lower bounds are not used when
+//' `ignore_blocks` is TRUE, because the psi score then depends on the trimmed
+//' least cost path.
+//'
+//' Time series with NA psi scores (constant time series) are ranked last.
+//' @param x (required, numeric matrix) query time series.
+//' @param tsl (required, list of numeric matrices or output of
+//' [tsl_prepare_cpp()] or [tsl_binary_map_cpp()]) time series with the same
+//' number of columns as `x`.
+//' @param k (optional, integer) number of time series to return. Default: 1
+//' @param distance (optional, character string) distance name from the "names"
+//' column of the dataset `distances` (see `distances$name`). Default: "euclidean"
+//' @param diagonal (optional, logical). If TRUE, diagonals are included in the
+//' computation of the cost matrix. Default: TRUE.
+//' @param bandwidth (optional, numeric) Size of the Sakoe-Chiba band at both
+//' sides of the diagonal used to constrain the least cost path. Expressed as a
+//' fraction of the number of matrix rows and columns. Unrestricted by default.
+//' Default: 1
+//' @param weighted (optional, logical). Only relevant when diagonal is TRUE.
+//' When TRUE, diagonal cost is weighted by a factor of 1.414214. Default: TRUE.
+//' @param ignore_blocks (optional, logical). If TRUE, blocks of consecutive path
+//' coordinates are trimmed to avoid inflating the psi distance. Default: FALSE.
+//' @param threads (optional, integer) number of threads. Values smaller than
+//' one use all available cores. Default: 1
+//' @return data frame with the columns "y" (index of the time series in
+//' `tsl`) and "psi", ordered by psi score, and the attribute "aligned" with
+//' the number of time series aligned with the query.
+//' @examples
+//' tsl <- tsl_simulate(
+//'   n = 10,
+//'   seed = 1
+//' )
+//'
+//' psi_dtw_knn_cpp(
+//'   x = tsl[[1]],
+//'   tsl = tsl[-1],
+//'   k = 3,
+//'   distance = "euclidean"
+//' )
+//' @family Rcpp_dissimilarity_analysis
+//' @export
+// [[Rcpp::export]]
+DataFrame psi_dtw_knn_cpp(
+    NumericMatrix x,
+    SEXP tsl,
+    int k = 1,
+    const std::string& distance = "euclidean",
+    bool diagonal = true,
+    double bandwidth = 1,
+    bool weighted = true,
+    bool ignore_blocks = false,
+    int threads = 1
+){
+
+  if (k < 1) {
+    Rcpp::stop("distantia::psi_dtw_knn_cpp(): argument 'k' must be a positive integer.");
+  }
+
+  if (x.nrow() < 1) {
+    Rcpp::stop("distantia::psi_dtw_knn_cpp(): argument 'x' must have at least one row.");
+  }
+
+  TslPrepared local;
+  TslPrepared* prepared = tsl_prepared_cpp(tsl, local, "psi_dtw_knn_cpp");
+  const std::vector<TslSeries>& series = prepared->series;
+  int n_series = static_cast<int>(series.size());
+
+  for (int s = 0; s < n_series; ++s) {
+    if (series[s].ncol != x.ncol()) {
+      Rcpp::stop("distantia::psi_dtw_knn_cpp(): time series in 'tsl' must have the same number of columns as 'x'.");
+    }
+  }
+
+  //query staged as the time series of a list
+  TslSeries query;
+  query.rows = matrix_rows_cpp(x);
+  query.nrow = x.nrow();
+  query.ncol = x.ncol();
+  query.hash = alignment_hash_rows(query.rows.data(), query.nrow, query.ncol);
+
+  std::vector<DistanceFunctionRaw> functions(
+    1,
+    select_distance_function_raw(distance)
+  );
+
+  StepPattern pattern = cost_matrix_step_pattern(diagonal, weighted);
+
+  //auto distances
+  std::vector<double> auto_distance;
+
+  tsl_prepared_auto_distance_cpp(
+    *prepared,
+    functions,
+    std::vector<char>(n_series, ignore_blocks ? 0 : 1),
+    threads,
+    auto_distance
+  );
+
+  double query_auto = ignore_blocks ? 0.0 : tsl_auto_distance_cpp(query, functions[0]);
+
+  // rounding to 8 decimal places
+  double factor = std::pow(10.0, 8);
+
+  //lower bounds; paths are complete or not depending on the number of rows
+  const double infinity = std::numeric_limits<double>::infinity();
+  std::vector<double> bound(n_series, -infinity);
+
+  if (!ignore_blocks && n_series > 0) {
+
+    std::vector<int> rows;
+
+    for (int s = 0; s < n_series; ++s) {
+      rows.push_back(series[s].nrow);
+    }
+
+    std::sort(rows.begin(), rows.end());
+    rows.erase(std::unique(rows.begin(), rows.end()), rows.end());
+
+    std::vector<char> complete(rows.size());
+
+    parallel_for_cpp(
+      static_cast<int>(rows.size()),
+      threads,
+      [&](int r) {
+        complete[r] = psi_dtw_path_complete_cpp(rows[r], query.nrow, pattern, NULL, bandwidth);
+      }
+    );
+
+    std::vector<PsiBoundScratch> scratch(resolve_threads_cpp(threads, n_series));
+
+    parallel_for_worker_cpp(
+      n_series,
+      threads,
+      [&](int s, int worker) {
+
+        int r = static_cast<int>(
+          std::lower_bound(rows.begin(), rows.end(), series[s].nrow) - rows.begin()
+        );
+
+        double b = std::round((query_auto + auto_distance[s]) * factor) / factor;
+
+        bound[s] = psi_dtw_lower_bound_cpp(
+          query,
+          series[s],
+          functions[0],
+          complete[r] != 0,
+          bandwidth,
+          b,
+          diagonal,
+          scratch[worker]
+        );
+
+      }
+    );
+
+  }
+
+  //time series in order of increasing lower bound
+  std::vector<int> order(n_series);
+
+  for (int s = 0; s < n_series; ++s) {
+    order[s] = s;
+  }
+
+  std::stable_sort(
+    order.begin(),
+    order.end(),
+    [&](int a, int b) {
+      return bound[a] < bound[b];
+    }
+  );
+
+  //k best time series found so far, as a max-heap of (psi, index), with NA
+  //psi scores as infinity
+  std::vector<std::pair<double, int>> best;
+  std::mutex best_mutex;
+  int aligned = 0;
+
+  k = std::min(k, n_series);
+
+  std::vector<DtwScratch> scratch(resolve_threads_cpp(threads, n_series));
+
+  parallel_for_worker_cpp(
+    n_series,
+    threads,
+    [&](int i, int worker) {
+
+      int s = order[i];
+
+      //psi score of the current k-th best time series, so the cost matrix
+      //is abandoned as soon as it proves the candidate is worse
+      double max_psi = infinity;
+
+      {
+        std::lock_guard<std::mutex> lock(best_mutex);
+
+        if (
+            static_cast<int>(best.size()) == k &&
+              bound[s] > best.front().first
+        ) {
+          return;
+        }
+
+        //NA psi scores are known without alignment
+        if (bound[s] == infinity) {
+
+          best.push_back(std::make_pair(infinity, s));
+          std::push_heap(best.begin(), best.end());
+
+          if (static_cast<int>(best.size()) > k) {
+            std::pop_heap(best.begin(), best.end());
+            best.pop_back();
+          }
+
+          return;
+
+        }
+
+        if (static_cast<int>(best.size()) == k) {
+          max_psi = best.front().first;
+        }
+
+      }
+
+      double psi = 0.0;
+
+      psi_dtw_sweep_cpp(
+        query,
+        series[s],
+        functions,
+        std::vector<int>(1, 0),
+        std::vector<int>(1, pattern),
+        std::vector<double>(1, bandwidth),
+        CostWindowSpec(),
+        ignore_blocks,
+        std::vector<double>(1, query_auto),
+        std::vector<double>(1, auto_distance[s]),
+        scratch[worker],
+        &psi,
+        max_psi
+      );
+
+      std::lock_guard<std::mutex> lock(best_mutex);
+
+      ++aligned;
+
+      //abandoned: worse than the k-th best time series
+      if (std::isnan(psi) && max_psi < infinity) {
+        return;
+      }
+
+      if (std::isnan(psi)) {
+        psi = infinity;
+      }
+
+      best.push_back(std::make_pair(psi, s));
+      std::push_heap(best.begin(), best.end());
+
+      if (static_cast<int>(best.size()) > k) {
+        std::pop_heap(best.begin(), best.end());
+        best.pop_back();
+      }
+
+    }
+  );
+
+  std::sort_heap(best.begin(), best.end());
+
+  IntegerVector y_index(best.size());
+  NumericVector psi(best.size());
+
+  for (std::size_t i = 0; i < best.size(); ++i) {
+    y_index[i] = best[i].second + 1;
+    psi[i] = best[i].first == infinity ? NA_REAL : best[i].first;
+  }
+
+  DataFrame out = DataFrame::create(
+    _["y"] = y_index,
+    _["psi"] = psi
+  );
+
+  out.attr("aligned") = aligned;
+
+  return out;
+
+}
@@ -0,0 +1,488 @@
+#include <Rcpp.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
+#include "distance_methods.h"
+#include "distance_matrix.h"
+#include "cost_matrix.h"
+#include "cost_path_raw.h"
+#include "alignment.h"
+#include "psi.h"
+#include "thread_pool.h"
+using namespace Rcpp;
+
+// Internal function to compute the distances between consecutive samples of
+// a time series stored as a row-major buffer, with `out[t]` the distance
+// between the rows `t - 1` and `t`, and `out[0]` zero.
+void psi_profile_auto_steps(
+    const double* rows,
+    int n,
+    int cols,
+    DistanceFunctionRaw f,
+    std::vector<double>& out
+){
+
+  out.assign(n, 0.0);
+
+  for (int t = 1; t < n; ++t) {
+    out[t] = f(
+      rows + static_cast<std::size_t>(t - 1) * cols,
+      rows + static_cast<std::size_t>(t) * cols,
+      cols
+    );
+  }
+
+}
+
+// Running sum with Neumaier's compensation of rounding errors, so values can
+// be added to and removed from a window sum without accumulating rounding
+// errors along a long time series.
+struct PsiProfileSum {
+
+  double sum = 0.0;
+  double compensation = 0.0;
+
+  void add(double value) {
+    double t = sum + value;
+    if (std::fabs(sum) >= std::fabs(value)) {
+      compensation += (sum - t) + value;
+    } else {
+      compensation += (value - t) + sum;
+    }
+    sum = t;
+  }
+
+  double value() const {
+    return sum + compensation;
+  }
+
+};
+
+// Internal function to sum `length` values of a vector starting at `start`,
+// `start + stride`, ..., for `windows` windows. Each window sum is the one of
+// the previous window plus the values entering it and minus the ones leaving
+// it, and is summed again from its values once as many values as it holds
+// were added, so the number of additions per window is proportional to
+// `stride` rather than to `length`. Writes one sum per window to `out`. Does
+// not touch the R API.
+void psi_profile_window_sums(
+    const std::vector<double>& values,
+    int start,
+    int length,
+    int stride,
+    int windows,
+    std::vector<double>& out
+){
+
+  out.resize(windows);
+
+  PsiProfileSum window;
+  int updated = length;
+
+  for (int k = 0; k < windows; ++k) {
+
+    int first = start + k * stride;
+
+    if (updated >= length || stride >= length) {
+
+      window = PsiProfileSum();
+
+      for (int t = first; t < first + length; ++t) {
+        window.add(values[t]);
+      }
+
+      updated = 0;
+
+    } else {
+
+      for (int t = first - stride; t < first; ++t) {
+        window.add(-values[t]);
+        window.add(values[t + length]);
+      }
+
+      updated += stride;
+
+    }
+
+    out[k] = window.value();
+
+  }
+
+}
+
+// Internal function to compute the lock-step psi score (see psi_ls_cpp()) of
+// the windows of `width` rows starting every `stride` rows of two time series
+// with `n` rows, stored as row-major buffers. Lock-step distances and
+// distances between consecutive samples are computed once, so the number of
+// distance computations does not depend on the width of the windows, and
+// summed with running window sums (see psi_profile_window_sums()). Writes one
+// psi score per window to `out`. Does not touch the R API.
+void psi_profile_ls_raw(
+    const double* x_rows,
+    const double* y_rows,
+    int n,
+    int cols,
+    int width,
+    int stride,
+    DistanceFunctionRaw f,
+    double* out
+){
+
+  std::vector<double> x_auto;
+  std::vector<double> y_auto;
+
+  psi_profile_auto_steps(x_rows, n, cols, f, x_auto);
+  psi_profile_auto_steps(y_rows, n, cols, f, y_auto);
+
+  //lock-step distances
+  std::vector<double> ls(n);
+
+  for (int t = 0; t < n; ++t) {
+    ls[t] = f(
+      y_rows + static_cast<std::size_t>(t) * cols,
+      x_rows + static_cast<std::size_t>(t) * cols,
+      cols
+    );
+  }
+
+  // rounding to 8 decimal places
+  double factor = std::pow(10.0, 8);
+
+  int windows = (n - width) / stride + 1;
+
+  std::vector<double> ls_sum;
+  std::vector<double> x_sum;
+  std::vector<double> y_sum;
+
+  psi_profile_window_sums(ls, 0, width, stride, windows, ls_sum);
+  psi_profile_window_sums(x_auto, 1, width - 1, stride, windows, x_sum);
+  psi_profile_window_sums(y_auto, 1, width - 1, stride, windows, y_sum);
+
+  for (int k = 0; k < windows; ++k) {
+
+    double x_distance = std::round(x_sum[k] * factor) / factor;
+    double y_distance = std::round(y_sum[k] * factor) / factor;
+    double b = std::round((x_distance + y_distance) * factor) / factor;
+
+    out[k] = psi_equation_cpp(
+      ls_sum[k],
+      b,
+      true
+    );
+
+  }
+
+}
+
+// Internal function to compute the dynamic time warping psi score (see
+// psi_dtw_cpp()) of the windows of `width` rows starting every `stride` rows
+// of two time series with `n` rows, stored as row-major buffers. Windows are
+// split in runs of consecutive windows, and each thread handles one run at a
+// time. The distance matrix of a window shares a block of (width - stride)
+// squared cells with the one of the previous window, which is shifted in
+// place, so only the new rows and columns are computed. Auto sums are running
+// window sums (see psi_profile_window_sums()) of distances between
+// consecutive samples computed once, unless `ignore_blocks` is true. Writes
+// one psi score per window to `out`. Does not touch the R API.
+void psi_profile_dtw_raw(
+    const double* x_rows,
+    const double* y_rows,
+    int n,
+    int cols,
+    int width,
+    int stride,
+    DistanceFunctionRaw f,
+    bool diagonal,
+    bool weighted,
+    bool ignore_blocks,
+    double bandwidth,
+    int threads,
+    double* out
+){
+
+  StepPattern pattern = cost_matrix_step_pattern(diagonal, weighted);
+
+  // rounding to 8 decimal places
+  double factor = std::pow(10.0, 8);
+
+  int windows = (n - width) / stride + 1;
+
+  std::vector<double> x_sum;
+  std::vector<double> y_sum;
+
+  if (!ignore_blocks) {
+    std::vector<double> x_auto;
+    std::vector<double> y_auto;
+    psi_profile_auto_steps(x_rows, n, cols, f, x_auto);
+    psi_profile_auto_steps(y_rows, n, cols, f, y_auto);
+    psi_profile_window_sums(x_auto, 1, width - 1, stride, windows, x_sum);
+    psi_profile_window_sums(y_auto, 1, width - 1, stride, windows, y_sum);
+  }
+
+  //runs of consecutive windows, several per thread to balance the load
+  int workers = resolve_threads_cpp(threads, windows);
+  int run = std::max(1, windows / (workers * 4));
+  int runs = (windows + run - 1) / run;
+
+  std::size_t cells = static_cast<std::size_t>(width) * width;
+  std::vector<std::vector<double>> dist_matrix(workers, std::vector<double>(cells));
+  std::vector<std::vector<double>> cost_matrix(workers, std::vector<double>(cells));
+  std::vector<Alignment> alignment(workers);
+
+  parallel_for_worker_cpp(
+    runs,
+    threads,
+    [&](int r, int w) {
+
+      double* d = dist_matrix[w].data();
+      double* m = cost_matrix[w].data();
+      Alignment& al = alignment[w];
+
+      int k_first = r * run;
+      int k_last = std::min(windows, k_first + run);
+
+      for (int k = k_first; k < k_last; ++k) {
+
+        int first = k * stride;
+        const double* x_w = x_rows + static_cast<std::size_t>(first) * cols;
+        const double* y_w = y_rows + static_cast<std::size_t>(first) * cols;
+
+        //cells shared with the previous window of the run
+        int shared = (k > k_first && stride < width) ? width - stride : 0;
+
+        for (int j = 0; j < shared; ++j) {
+          std::memmove(
+            d + static_cast<std::size_t>(j) * width,
+            d + static_cast<std::size_t>(j + stride) * width + stride,
+            shared * sizeof(double)
+          );
+        }
+
+        //new cells, rows are samples of y and columns are samples of x
+        for (int j = 0; j < width; ++j) {
+
+          const double* x_j = x_w + static_cast<std::size_t>(j) * cols;
+          double* d_j = d + static_cast<std::size_t>(j) * width;
+
+          for (int i = j < shared ? shared : 0; i < width; ++i) {
+            d_j[i] = f(
+              y_w + static_cast<std::size_t>(i) * cols,
+              x_j,
+              cols
+            );
+          }
+
+        }
+
+        cost_matrix_batch(
+          d,
+          m,
+          width,
+          width,
+          1,
+          pattern
+        );
+
+        cost_path_raw(
+          d,
+          m,
+          width,
+          width,
+          pattern,
+          bandwidth,
+          al.path
+        );
+
+        al.x_rows = width;
+        al.y_rows = width;
+
+        double b;
+
+        if (ignore_blocks) {
+
+          cost_path_trim_raw(al.path);
+
+          b = alignment_auto_sum_raw(
+            al,
+            x_w,
+            y_w,
+            cols,
+            f,
+            true
+          );
+
+        } else {
+
+          double x_distance = std::round(x_sum[k] * factor) / factor;
+          double y_distance = std::round(y_sum[k] * factor) / factor;
+          b = std::round((x_distance + y_distance) * factor) / factor;
+
+        }
+
+        out[k] = psi_equation_cpp(
+          cost_path_sum_raw(al.path),
+          b,
+          diagonal
+        );
+
+      }
+
+    }
+  );
+
+}
+
+//' (C++) Rolling Window Psi Dissimilarity Profile of Two Time Series
+//' @description Computes the psi dissimilarity score between two time series
+//' observed at the same times over sliding windows of `width` rows starting
+//' every `stride` rows, to show how their dissimilarity changes over time.
+//' Each score is the one of [psi_ls_cpp()] (when `lock_step` is TRUE) or
+//' [psi_dtw_cpp()] on the rows of the window of both time series, but the
+//' work shared by overlapping windows is not repeated:
+//' \itemize{
+//'   \item The distances between consecutive samples (auto sums) and between
+//'   samples observed at the same time (lock-step) are computed once, and
+//'   window sums are updated with the values entering and leaving each
+//'   window, so the cost of the lock-step profile does not depend on the
+//'   width of the windows. Running sums are compensated for rounding
+//'   errors, so scores match the ones of each window up to rounding.
+//'   \item Consecutive windows share a block of the distance matrix used by
+//'   dynamic time warping, which is reused, so only `stride` new rows and
+//'   columns of the distance matrix are computed per window. Windows are
+//'   distributed over `threads` threads.
+//' }
+//' @param x (required, numeric matrix) time series.
+//' @param y (required, numeric matrix) time series with the same number of
+//' rows and columns as `x`.
+//' @param width (required, integer) number of rows of each window.
+//' @param stride (optional, integer) number of rows between the first rows of
+//' consecutive windows. Default: 1
+//' @param distance (optional, character string) distance name from the "names"
+//' column of the dataset `distances` (see `distances$name`). Default: "euclidean"
+//' @param lock_step (optional, logical) If TRUE, lock-step psi scores are
+//' computed instead of dynamic time warping ones. Default: FALSE
+//' @param diagonal (optional, logical). If TRUE, diagonals are included in the
+//' computation of the cost matrix. Ignored when `lock_step` is TRUE.
+//' Default: TRUE.
+//' @param weighted (optional, logical). Only relevant when diagonal is TRUE.
+//' When TRUE, diagonal cost is weighted by a factor of 1.414214. Default: TRUE.
+//' @param ignore_blocks (optional, logical). If TRUE, blocks of consecutive path
+//' coordinates are trimmed to avoid inflating the psi distance. Ignored when
+//' `lock_step` is TRUE. Default: FALSE.
+//' @param bandwidth (optional, numeric) Size of the Sakoe-Chiba band at both
+//' sides of the diagonal used to constrain the least cost path of each window.
+//' Expressed as a fraction of the number of rows of the window. Ignored when
+//' `lock_step` is TRUE. Default: 1
+//' @param threads (optional, integer) number of threads. Values smaller than
+//' one use all available cores. Default: 1
+//' @return data frame with the columns "start" and "end" (first and last rows
+//' of each window) and "psi".
+//' @examples
+//' x <- zoo_simulate(
+//'   rows = 500,
+//'   seed = 1
+//' )
+//'
+//' y <- zoo_simulate(
+//'   rows = 500,
+//'   seed = 2
+//' )
+//'
+//' psi_profile_cpp(
+//'   x = x,
+//'   y = y,
+//'   width = 50,
+//'   stride = 10,
+//'   distance = "euclidean"
+//' )
+//' @family Rcpp_dissimilarity_analysis
+//' @export
+// [[Rcpp::export]]
+DataFrame psi_profile_cpp(
+    NumericMatrix x,
+    NumericMatrix y,
+    int width,
+    int stride = 1,
+    const std::string& distance = "euclidean",
+    bool lock_step = false,
+    bool diagonal = true,
+    bool weighted = true,
+    bool ignore_blocks = false,
+    double bandwidth = 1,
+    int threads = 1
+){
+
+  if (x.nrow() != y.nrow() || x.ncol() != y.ncol()) {
+    Rcpp::stop("distantia::psi_profile_cpp(): 'x' and 'y' must have the same number of rows and columns.");
+  }
+
+  if (width < 2 || width > x.nrow()) {
+    Rcpp::stop("distantia::psi_profile_cpp(): argument 'width' must be an integer between 2 and the number of rows of 'x'.");
+  }
+
+  if (stride < 1) {
+    Rcpp::stop("distantia::psi_profile_cpp(): argument 'stride' must be a positive integer.");
+  }
+
+  DistanceFunctionRaw f = select_distance_function_raw(distance);
+
+  int n = x.nrow();
+  int cols = x.ncol();
+
+  std::vector<double> x_rows = matrix_rows_cpp(x);
+  std::vector<double> y_rows = matrix_rows_cpp(y);
+
+  int windows = (n - width) / stride + 1;
+  std::vector<double> psi(windows);
+
+  if (lock_step) {
+
+    psi_profile_ls_raw(
+      x_rows.data(),
+      y_rows.data(),
+      n,
+      cols,
+      width,
+      stride,
+      f,
+      psi.data()
+    );
+
+  } else {
+
+    psi_profile_dtw_raw(
+      x_rows.data(),
+      y_rows.data(),
+      n,
+      cols,
+      width,
+      stride,
+      f,
+      diagonal,
+      weighted,
+      ignore_blocks,
+      bandwidth,
+      threads,
+      psi.data()
+    );
+
+  }
+
+  IntegerVector out_start(windows);
+  IntegerVector out_end(windows);
+  NumericVector out_psi(windows);
+
+  for (int k = 0; k < windows; ++k) {
+    out_start[k] = k * stride + 1;
+    out_end[k] = k * stride + width;
+    out_psi[k] = psi[k];
+  }
+
+  return DataFrame::create(
+    _["start"] = out_start,
+    _["end"] = out_end,
+    _["psi"] = out_psi
+  );
+
+}
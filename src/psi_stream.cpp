@@ -0,0 +1,614 @@
+#include <Rcpp.h>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <limits>
+#include <vector>
+#include "auto_sum.h"
+#include "cost_matrix.h"
+#include "distance_methods.h"
+#include "distance_matrix.h"
+#include "psi.h"
+using namespace Rcpp;
+
+namespace {
+
+// Layout of checkpoint files of streaming alignments: magic string, format
+// version, byte order mark, dimensions of the reference time series, number
+// of samples appended so far, arguments of the alignment, running auto sums,
+// distance name, and the buffers of the stream as doubles.
+const char psi_stream_magic[8] = {'D', 'S', 'T', 'R', 'E', 'A', 'M', '1'};
+const std::uint32_t psi_stream_version = 1;
+const std::uint32_t psi_stream_byte_order = 0x01020304;
+
+// Streaming alignment of an incoming time series `x` against a reference time
+// series `y`. Only the last column of the cost matrix is kept, with the sum of
+// distances of the least cost path traced back from each of its cells, so
+// appending a sample of `x` takes one pass over the samples of `y`.
+struct DtwStream {
+  std::vector<double> reference;
+  int nrow;
+  int ncol;
+  std::string distance;
+  DistanceFunctionRaw f;
+  bool diagonal;
+  bool weighted;
+  std::uint64_t samples;
+  std::vector<double> last_sample;
+  double x_auto;
+  double y_auto;
+  std::vector<double> cost;
+  std::vector<double> path_sum;
+  std::vector<double> dist;
+  std::vector<double> next_cost;
+  std::vector<double> next_path_sum;
+};
+
+template <class T>
+void psi_stream_put(std::ofstream& out, T value){
+  out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <class T>
+bool psi_stream_get(std::ifstream& in, T& value){
+  in.read(reinterpret_cast<char*>(&value), sizeof(T));
+  return static_cast<bool>(in);
+}
+
+void psi_stream_put_doubles(std::ofstream& out, const std::vector<double>& values){
+  out.write(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(double));
+}
+
+bool psi_stream_get_doubles(std::ifstream& in, std::vector<double>& values, std::size_t n){
+  values.resize(n);
+  in.read(reinterpret_cast<char*>(values.data()), n * sizeof(double));
+  return static_cast<bool>(in);
+}
+
+}
+
+// Internal function to get the streaming alignment of an external pointer.
+DtwStream* psi_stream_get_cpp(
+    SEXP stream,
+    const std::string& function_name
+){
+
+  if (TYPEOF(stream) != EXTPTRSXP || !Rf_inherits(stream, "psi_dtw_stream")) {
+    Rcpp::stop("distantia::" + function_name + "(): argument 'stream' must be the output of psi_dtw_stream_cpp() or psi_dtw_stream_load_cpp().");
+  }
+
+  if (R_ExternalPtrAddr(stream) == nullptr) {
+    Rcpp::stop("distantia::" + function_name + "(): the stream is no longer valid (for example, after restoring a saved R session). Save it with psi_dtw_stream_save_cpp() and load it with psi_dtw_stream_load_cpp() instead.");
+  }
+
+  XPtr<DtwStream> ptr(stream);
+
+  return ptr.get();
+
+}
+
+// Internal function to hand a streaming alignment over to R as an external
+// pointer that deletes it when garbage collected.
+SEXP psi_stream_wrap_cpp(
+    DtwStream* stream
+){
+
+  XPtr<DtwStream> ptr(stream, true);
+  ptr.attr("class") = "psi_dtw_stream";
+
+  return ptr;
+
+}
+
+// Internal function to compute the current psi score of a streaming alignment,
+// as in psi_dtw_sweep_cpp().
+double psi_stream_score_cpp(
+    const DtwStream& stream
+){
+
+  if (stream.samples == 0) {
+    return NA_REAL;
+  }
+
+  // rounding to 8 decimal places
+  double factor = std::pow(10.0, 8);
+
+  double a = std::round(stream.path_sum[stream.nrow - 1] * factor) / factor;
+  double x_auto = std::round(stream.x_auto * factor) / factor;
+  double b = std::round((x_auto + stream.y_auto) * factor) / factor;
+
+  return psi_equation_cpp(
+    a,
+    b,
+    stream.diagonal
+  );
+
+}
+
+// Internal function to append one sample to a streaming alignment. The new
+// column of the cost matrix comes from cost_matrix_column(), and the least cost
+// path traced back from each of its cells moves to the neighbor of lowest
+// cost, in the order of preference of cost_path_raw(), so its sum of
+// distances is the distance of the cell plus the sum of that neighbor. Does
+// not touch the R API.
+void psi_stream_append_cpp(
+    DtwStream& stream,
+    const double* sample
+){
+
+  int yn = stream.nrow;
+  int ncol = stream.ncol;
+
+  for (int i = 0; i < yn; ++i) {
+    stream.dist[i] = stream.f(
+      stream.reference.data() + static_cast<std::size_t>(i) * ncol,
+      sample,
+      ncol
+    );
+  }
+
+  const std::vector<double>& d = stream.dist;
+  std::vector<double>& m = stream.next_cost;
+  std::vector<double>& s = stream.next_path_sum;
+  const std::vector<double>& m_left = stream.cost;
+  const std::vector<double>& s_left = stream.path_sum;
+
+  cost_matrix_column(
+    d.data(),
+    stream.samples == 0 ? NULL : m_left.data(),
+    m.data(),
+    yn,
+    1,
+    cost_matrix_step_pattern(stream.diagonal, stream.weighted)
+  );
+
+  if (stream.samples == 0) {
+
+    s[0] = d[0];
+
+    for (int i = 1; i < yn; ++i) {
+      s[i] = d[i] + s[i - 1];
+    }
+
+  } else {
+
+    s[0] = d[0] + s_left[0];
+
+    for (int i = 1; i < yn; ++i) {
+
+      //neighbor of the least cost path
+      double min_cost = std::numeric_limits<double>::max();
+      double neighbor_sum = 0.0;
+
+      if (stream.diagonal && m_left[i - 1] < min_cost) {
+        min_cost = m_left[i - 1];
+        neighbor_sum = s_left[i - 1];
+      }
+
+      if (m[i - 1] < min_cost) {
+        min_cost = m[i - 1];
+        neighbor_sum = s[i - 1];
+      }
+
+      if (m_left[i] < min_cost) {
+        min_cost = m_left[i];
+        neighbor_sum = s_left[i];
+      }
+
+      s[i] = d[i] + neighbor_sum;
+
+    }
+
+    stream.x_auto += stream.f(
+      stream.last_sample.data(),
+      sample,
+      ncol
+    );
+
+  }
+
+  stream.cost.swap(stream.next_cost);
+  stream.path_sum.swap(stream.next_path_sum);
+  stream.last_sample.assign(sample, sample + ncol);
+  stream.samples += 1;
+
+}
+
+//' (C++) Streaming Psi Dissimilarity Score via Dynamic Time Warping
+//' @description Creates a streaming alignment between an incoming time series,
+//' whose samples arrive over time, and a reference time series `y`. Samples of
+//' the incoming time series are appended with [psi_dtw_stream_append_cpp()],
+//' which updates the psi score of all samples received so far against `y`
+//' without computing the distance and cost matrices again: the stream only
+//' keeps the last column of the cost matrix, the sum of distances of the least
+//' cost path traced back from each of its cells, and running auto sums, so
+//' each appended sample takes one pass over the samples of `y`. Psi scores are
+//' the ones of [psi_dtw_cpp()] with the incoming time series as `x`,
+//' `ignore_blocks = FALSE`, and `bandwidth = 1` (Sakoe-Chiba bands depend on
+//' the final length of the incoming time series, and are not supported), up
+//' to the floating point rounding of the sum of distances of the least cost
+//' path. Streams can be saved to a checkpoint file with
+//' [psi_dtw_stream_save_cpp()], and loaded by a restarted process with
+//' [psi_dtw_stream_load_cpp()].
+//' @param y (required, numeric matrix) reference time series.
+//' @param distance (optional, character string) distance name from the "names"
+//' column of the dataset `distances` (see `distances$name`). Default: "euclidean"
+//' @param diagonal (optional, logical). If TRUE, diagonals are included in the
+//' computation of the cost matrix. Default: TRUE.
+//' @param weighted (optional, logical). Only relevant when diagonal is TRUE.
+//' When TRUE, diagonal cost is weighted by a factor of 1.414214. Default: TRUE.
+//' @return external pointer of class "psi_dtw_stream".
+//' @examples
+//' x <- zoo_simulate(seed = 1)
+//' y <- zoo_simulate(seed = 2)
+//'
+//' stream <- psi_dtw_stream_cpp(
+//'   y = y,
+//'   distance = "euclidean"
+//' )
+//'
+//' #samples arriving in two batches
+//' psi_dtw_stream_append_cpp(
+//'   stream = stream,
+//'   x = x[1:50, , drop = FALSE]
+//' )
+//'
+//' psi <- psi_dtw_stream_append_cpp(
+//'   stream = stream,
+//'   x = x[51:nrow(x), , drop = FALSE]
+//' )
+//'
+//' #same as psi_dtw_cpp() on all samples
+//' psi[length(psi)]
+//'
+//' psi_dtw_cpp(
+//'   x = x,
+//'   y = y,
+//'   distance = "euclidean"
+//' )
+//' @family Rcpp_dissimilarity_analysis
+//' @export
+// [[Rcpp::export]]
+SEXP psi_dtw_stream_cpp(
+    NumericMatrix y,
+    const std::string& distance = "euclidean",
+    bool diagonal = true,
+    bool weighted = true
+){
+
+  if (y.nrow() < 1 || y.ncol() < 1) {
+    Rcpp::stop("distantia::psi_dtw_stream_cpp(): argument 'y' must have at least one row and one column.");
+  }
+
+  DtwStream* stream = new DtwStream();
+
+  stream->reference = matrix_rows_cpp(y);
+  stream->nrow = y.nrow();
+  stream->ncol = y.ncol();
+  stream->distance = distance;
+  stream->f = select_distance_function_raw(distance);
+  stream->diagonal = diagonal;
+  stream->weighted = weighted;
+  stream->samples = 0;
+  stream->last_sample.assign(y.ncol(), 0.0);
+  stream->x_auto = 0.0;
+
+  //auto sum of the reference, as in tsl_auto_distance_cpp()
+  std::vector<int> from;
+  std::vector<int> to;
+
+  auto_sum_pairs_cpp(
+    stream->nrow,
+    std::vector<int>(),
+    false,
+    from,
+    to
+  );
+
+  stream->y_auto = auto_distance_rows_cpp(
+    stream->reference.data(),
+    stream->ncol,
+    from,
+    to,
+    stream->f
+  );
+
+  stream->cost.assign(stream->nrow, 0.0);
+  stream->path_sum.assign(stream->nrow, 0.0);
+  stream->dist.assign(stream->nrow, 0.0);
+  stream->next_cost.assign(stream->nrow, 0.0);
+  stream->next_path_sum.assign(stream->nrow, 0.0);
+
+  return psi_stream_wrap_cpp(stream);
+
+}
+
+//' (C++) Append Samples to a Streaming Psi Dissimilarity Score
+//' @description Appends samples of the incoming time series to a streaming
+//' alignment created with [psi_dtw_stream_cpp()], and returns the psi score of
+//' all samples received so far against the reference time series after each
+//' appended sample. Each sample takes one pass over the samples of the
+//' reference time series, regardless of the number of samples received before.
+//' The stream is modified in place.
+//' @param stream (required, external pointer) output of [psi_dtw_stream_cpp()]
+//' or [psi_dtw_stream_load_cpp()].
+//' @param x (required, numeric matrix) new samples of the incoming time series,
+//' with the same columns as the reference time series.
+//' @return numeric vector with one psi score per row of `x`.
+//' @examples
+//' x <- zoo_simulate(seed = 1)
+//' y <- zoo_simulate(seed = 2)
+//'
+//' stream <- psi_dtw_stream_cpp(y = y)
+//'
+//' psi_dtw_stream_append_cpp(
+//'   stream = stream,
+//'   x = x
+//' )
+//' @family Rcpp_dissimilarity_analysis
+//' @export
+// [[Rcpp::export]]
+NumericVector psi_dtw_stream_append_cpp(
+    SEXP stream,
+    NumericMatrix x
+){
+
+  DtwStream* s = psi_stream_get_cpp(stream, "psi_dtw_stream_append_cpp");
+
+  if (x.ncol() != s->ncol) {
+    Rcpp::stop("distantia::psi_dtw_stream_append_cpp(): argument 'x' must have the same number of columns as the reference time series of the stream.");
+  }
+
+  std::vector<double> rows = matrix_rows_cpp(x);
+  NumericVector psi(x.nrow());
+
+  for (int r = 0; r < x.nrow(); ++r) {
+
+    psi_stream_append_cpp(
+      *s,
+      rows.data() + static_cast<std::size_t>(r) * s->ncol
+    );
+
+    psi[r] = psi_stream_score_cpp(*s);
+
+  }
+
+  return psi;
+
+}
+
+//' (C++) State of a Streaming Psi Dissimilarity Score
+//' @description Returns the number of samples appended to a streaming
+//' alignment (see [psi_dtw_stream_cpp()]) and their current psi score against
+//' the reference time series, for example after loading a checkpoint with
+//' [psi_dtw_stream_load_cpp()].
+//' @param stream (required, external pointer) output of [psi_dtw_stream_cpp()]
+//' or [psi_dtw_stream_load_cpp()].
+//' @return named numeric vector with the elements "samples" and "psi". The psi
+//' score is NA before any sample is appended.
+//' @examples
+//' x <- zoo_simulate(seed = 1)
+//' y <- zoo_simulate(seed = 2)
+//'
+//' stream <- psi_dtw_stream_cpp(y = y)
+//'
+//' psi_dtw_stream_append_cpp(
+//'   stream = stream,
+//'   x = x[1:10, , drop = FALSE]
+//' )
+//'
+//' psi_dtw_stream_state_cpp(stream = stream)
+//' @family Rcpp_dissimilarity_analysis
+//' @export
+// [[Rcpp::export]]
+NumericVector psi_dtw_stream_state_cpp(
+    SEXP stream
+){
+
+  DtwStream* s = psi_stream_get_cpp(stream, "psi_dtw_stream_state_cpp");
+
+  return NumericVector::create(
+    _["samples"] = static_cast<double>(s->samples),
+    _["psi"] = psi_stream_score_cpp(*s)
+  );
+
+}
+
+//' (C++) Save a Streaming Psi Dissimilarity Score to a Checkpoint File
+//' @description Writes the state of a streaming alignment (see
+//' [psi_dtw_stream_cpp()]) to a binary checkpoint file, so a restarted process
+//' can load it with [psi_dtw_stream_load_cpp()] and keep appending samples
+//' where it stopped. The file holds the reference time series, the arguments
+//' of the alignment, and the last column of the cost matrix, and its size does
+//' not grow with the number of samples appended. The file is written to a
+//' temporary file first, and then renamed, so an interrupted write does not
+//' corrupt an existing checkpoint.
+//' @param stream (required, external pointer) output of [psi_dtw_stream_cpp()]
+//' or [psi_dtw_stream_load_cpp()].
+//' @param file (required, character string) path of the checkpoint file.
+//' @return character string, path of the checkpoint file.
+//' @examples
+//' x <- zoo_simulate(seed = 1)
+//' y <- zoo_simulate(seed = 2)
+//'
+//' stream <- psi_dtw_stream_cpp(y = y)
+//'
+//' psi_dtw_stream_append_cpp(
+//'   stream = stream,
+//'   x = x[1:50, , drop = FALSE]
+//' )
+//'
+//' file <- tempfile(fileext = ".dstream")
+//'
+//' psi_dtw_stream_save_cpp(
+//'   stream = stream,
+//'   file = file
+//' )
+//'
+//' #in a restarted process
+//' stream <- psi_dtw_stream_load_cpp(file = file)
+//'
+//' psi_dtw_stream_append_cpp(
+//'   stream = stream,
+//'   x = x[51:nrow(x), , drop = FALSE]
+//' )
+//' @family Rcpp_dissimilarity_analysis
+//' @export
+// [[Rcpp::export]]
+std::string psi_dtw_stream_save_cpp(
+    SEXP stream,
+    const std::string& file
+){
+
+  DtwStream* s = psi_stream_get_cpp(stream, "psi_dtw_stream_save_cpp");
+
+  std::string file_tmp = file + ".tmp";
+  std::ofstream out(file_tmp.c_str(), std::ios::binary | std::ios::trunc);
+
+  if (!out) {
+    Rcpp::stop("distantia::psi_dtw_stream_save_cpp(): file '" + file + "' cannot be written.");
+  }
+
+  out.write(psi_stream_magic, sizeof(psi_stream_magic));
+  psi_stream_put<std::uint32_t>(out, psi_stream_version);
+  psi_stream_put<std::uint32_t>(out, psi_stream_byte_order);
+  psi_stream_put<std::uint64_t>(out, s->nrow);
+  psi_stream_put<std::uint64_t>(out, s->ncol);
+  psi_stream_put<std::uint64_t>(out, s->samples);
+  psi_stream_put<std::uint32_t>(out, s->diagonal ? 1 : 0);
+  psi_stream_put<std::uint32_t>(out, s->weighted ? 1 : 0);
+  psi_stream_put<double>(out, s->x_auto);
+  psi_stream_put<double>(out, s->y_auto);
+  psi_stream_put<std::uint64_t>(out, s->distance.size());
+  out.write(s->distance.data(), s->distance.size());
+  psi_stream_put_doubles(out, s->reference);
+  psi_stream_put_doubles(out, s->last_sample);
+  psi_stream_put_doubles(out, s->cost);
+  psi_stream_put_doubles(out, s->path_sum);
+
+  out.close();
+
+  if (!out) {
+    std::remove(file_tmp.c_str());
+    Rcpp::stop("distantia::psi_dtw_stream_save_cpp(): file '" + file + "' cannot be written.");
+  }
+
+  std::remove(file.c_str());
+
+  if (std::rename(file_tmp.c_str(), file.c_str()) != 0) {
+    std::remove(file_tmp.c_str());
+    Rcpp::stop("distantia::psi_dtw_stream_save_cpp(): file '" + file + "' cannot be written.");
+  }
+
+  return file;
+
+}
+
+//' (C++) Load a Streaming Psi Dissimilarity Score from a Checkpoint File
+//' @description Reads a checkpoint file written by [psi_dtw_stream_save_cpp()]
+//' and returns the streaming alignment it holds, ready to keep appending
+//' samples with [psi_dtw_stream_append_cpp()] with the same results as the
+//' stream that was saved.
+//' @param file (required, character string) path of the checkpoint file.
+//' @return external pointer of class "psi_dtw_stream".
+//' @examples
+//' y <- zoo_simulate(seed = 2)
+//'
+//' stream <- psi_dtw_stream_cpp(y = y)
+//'
+//' file <- tempfile(fileext = ".dstream")
+//'
+//' psi_dtw_stream_save_cpp(
+//'   stream = stream,
+//'   file = file
+//' )
+//'
+//' stream <- psi_dtw_stream_load_cpp(file = file)
+//'
+//' psi_dtw_stream_state_cpp(stream = stream)
+//' @family Rcpp_dissimilarity_analysis
+//' @export
+// [[Rcpp::export]]
+SEXP psi_dtw_stream_load_cpp(
+    const std::string& file
+){
+
+  std::ifstream in(file.c_str(), std::ios::binary);
+
+  if (!in) {
+    Rcpp::stop("distantia::psi_dtw_stream_load_cpp(): file '" + file + "' cannot be opened.");
+  }
+
+  std::string invalid = "distantia::psi_dtw_stream_load_cpp(): file '" + file + "' is not a valid stream checkpoint.";
+
+  char magic[sizeof(psi_stream_magic)];
+  in.read(magic, sizeof(magic));
+
+  std::uint32_t version = 0;
+  std::uint32_t byte_order = 0;
+  std::uint64_t nrow = 0;
+  std::uint64_t ncol = 0;
+  std::uint64_t samples = 0;
+  std::uint32_t diagonal = 0;
+  std::uint32_t weighted = 0;
+  double x_auto = 0.0;
+  double y_auto = 0.0;
+  std::uint64_t distance_size = 0;
+
+  if (
+      !in ||
+        std::string(magic, sizeof(magic)) != std::string(psi_stream_magic, sizeof(psi_stream_magic)) ||
+        !psi_stream_get(in, version) ||
+        version != psi_stream_version ||
+        !psi_stream_get(in, byte_order) ||
+        byte_order != psi_stream_byte_order ||
+        !psi_stream_get(in, nrow) ||
+        !psi_stream_get(in, ncol) ||
+        !psi_stream_get(in, samples) ||
+        !psi_stream_get(in, diagonal) ||
+        !psi_stream_get(in, weighted) ||
+        !psi_stream_get(in, x_auto) ||
+        !psi_stream_get(in, y_auto) ||
+        !psi_stream_get(in, distance_size) ||
+        nrow < 1 ||
+        ncol < 1 ||
+        nrow > static_cast<std::uint64_t>(INT32_MAX) ||
+        ncol > static_cast<std::uint64_t>(INT32_MAX) ||
+        distance_size > 256
+  ) {
+    Rcpp::stop(invalid);
+  }
+
+  std::string distance(static_cast<std::size_t>(distance_size), '\0');
+  in.read(&distance[0], static_cast<std::streamsize>(distance_size));
+
+  DtwStream stream;
+
+  stream.nrow = static_cast<int>(nrow);
+  stream.ncol = static_cast<int>(ncol);
+
+  if (
+      !in ||
+        !psi_stream_get_doubles(in, stream.reference, static_cast<std::size_t>(nrow * ncol)) ||
+        !psi_stream_get_doubles(in, stream.last_sample, static_cast<std::size_t>(ncol)) ||
+        !psi_stream_get_doubles(in, stream.cost, static_cast<std::size_t>(nrow)) ||
+        !psi_stream_get_doubles(in, stream.path_sum, static_cast<std::size_t>(nrow))
+  ) {
+    Rcpp::stop(invalid);
+  }
+
+  stream.distance = distance;
+  stream.f = select_distance_function_raw(distance);
+  stream.diagonal = diagonal != 0;
+  stream.weighted = weighted != 0;
+  stream.samples = samples;
+  stream.x_auto = x_auto;
+  stream.y_auto = y_auto;
+  stream.dist.assign(stream.nrow, 0.0);
+  stream.next_cost.assign(stream.nrow, 0.0);
+  stream.next_path_sum.assign(stream.nrow, 0.0);
+
+  return psi_stream_wrap_cpp(new DtwStream(stream));
+
+}
@@ -0,0 +1,365 @@
+#include <Rcpp.h>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+#include "cost_matrix.h"
+#include "distance_methods.h"
+#include "distance_matrix.h"
+#include "psi.h"
+using namespace Rcpp;
+
+// Internal function to compute, for each sample `j` of a long time series `x`,
+// the least cost path of subsequence dynamic time warping between a pattern
+// `y` and any segment of `x` ending at `j`. The cost matrix has the samples of
+// `y` as rows and the samples of `x` as columns, as in cost_matrix_batch(),
+// but its first row holds the distances only, so paths may start at any
+// sample of `x` (open begin), and its last row holds the cost of the best
+// path ending at each sample of `x` (open end). The matrix is computed column
+// by column with cost_matrix_column() keeping the last column only. The path
+// traced back from each cell moves to the neighbor of lowest cost in the
+// order of preference of cost_path_raw(), and its first sample of `x`, its
+// sum of distances, and the auto sum of its segment of `x` (summed in order
+// from its first sample, as in auto_distance_rows_cpp()) are carried along the
+// columns. Writes them for the path ending at each sample of `x` to `start`
+// (0-based), `path_sum`, and `segment_auto`. Does not touch the R API.
+void psi_dtw_subsequence_raw(
+    const double* x_rows,
+    int xn,
+    const double* y_rows,
+    int yn,
+    int cols,
+    DistanceFunctionRaw f,
+    bool diagonal,
+    bool weighted,
+    std::vector<int>& start,
+    std::vector<double>& path_sum,
+    std::vector<double>& segment_auto
+){
+
+  start.assign(xn, 0);
+  path_sum.assign(xn, 0.0);
+  segment_auto.assign(xn, 0.0);
+
+  std::vector<double> d(yn);
+  std::vector<double> m(yn);
+  std::vector<double> s(yn);
+  std::vector<double> u(yn);
+  std::vector<int> b(yn);
+  std::vector<double> m_left(yn);
+  std::vector<double> s_left(yn);
+  std::vector<double> u_left(yn);
+  std::vector<int> b_left(yn);
+
+  for (int j = 0; j < xn; ++j) {
+
+    const double* x_j = x_rows + static_cast<std::size_t>(j) * cols;
+
+    for (int i = 0; i < yn; ++i) {
+      d[i] = f(
+        y_rows + static_cast<std::size_t>(i) * cols,
+        x_j,
+        cols
+      );
+    }
+
+    //distance from the previous sample of x, added to the auto sum of the
+    //segment by moves from the previous column
+    double step = 0.0;
+
+    if (j > 0) {
+      step = f(
+        x_j - cols,
+        x_j,
+        cols
+      );
+    }
+
+    cost_matrix_column(
+      d.data(),
+      j == 0 ? NULL : m_left.data(),
+      m.data(),
+      yn,
+      1,
+      cost_matrix_step_pattern(diagonal, weighted),
+      0,
+      yn - 1,
+      true
+    );
+
+    //open begin: paths may start at any sample of x
+    s[0] = d[0];
+    u[0] = 0.0;
+    b[0] = j;
+
+    for (int i = 1; i < yn; ++i) {
+
+      if (j == 0) {
+        s[i] = d[i] + s[i - 1];
+        u[i] = u[i - 1];
+        b[i] = b[i - 1];
+        continue;
+      }
+
+      //neighbor of the least cost path
+      double min_cost = std::numeric_limits<double>::max();
+      double neighbor_sum = 0.0;
+      double neighbor_auto = 0.0;
+      int neighbor_start = j;
+
+      if (diagonal && m_left[i - 1] < min_cost) {
+        min_cost = m_left[i - 1];
+        neighbor_sum = s_left[i - 1];
+        neighbor_auto = u_left[i - 1] + step;
+        neighbor_start = b_left[i - 1];
+      }
+
+      if (m[i - 1] < min_cost) {
+        min_cost = m[i - 1];
+        neighbor_sum = s[i - 1];
+        neighbor_auto = u[i - 1];
+        neighbor_start = b[i - 1];
+      }
+
+      if (m_left[i] < min_cost) {
+        min_cost = m_left[i];
+        neighbor_sum = s_left[i];
+        neighbor_auto = u_left[i] + step;
+        neighbor_start = b_left[i];
+      }
+
+      s[i] = d[i] + neighbor_sum;
+      u[i] = neighbor_auto;
+      b[i] = neighbor_start;
+
+    }
+
+    //open end: best path ending at this sample of x
+    start[j] = b[yn - 1];
+    path_sum[j] = s[yn - 1];
+    segment_auto[j] = u[yn - 1];
+
+    m.swap(m_left);
+    s.swap(s_left);
+    u.swap(u_left);
+    b.swap(b_left);
+
+  }
+
+}
+
+// Internal function to select the `k` non-overlapping matches with the lowest
+// psi scores among the best matches ending at each sample of `x`. Matches are
+// taken in order of increasing psi score (ties by end), and skipped when they
+// share samples of `x` with a match taken before. Matches with NA psi scores
+// are never taken. Returns the ends of the selected matches.
+std::vector<int> psi_dtw_subsequence_select(
+    const std::vector<int>& start,
+    const std::vector<double>& psi,
+    int k
+){
+
+  std::vector<int> order;
+
+  for (std::size_t j = 0; j < psi.size(); ++j) {
+    if (!std::isnan(psi[j])) {
+      order.push_back(static_cast<int>(j));
+    }
+  }
+
+  std::stable_sort(
+    order.begin(),
+    order.end(),
+    [&](int a, int b) { return psi[a] < psi[b]; }
+  );
+
+  std::vector<int> selected;
+
+  for (int j : order) {
+
+    if (static_cast<int>(selected.size()) >= k) {
+      break;
+    }
+
+    bool overlap = false;
+
+    for (int e : selected) {
+      if (start[j] <= e && start[e] <= j) {
+        overlap = true;
+        break;
+      }
+    }
+
+    if (!overlap) {
+      selected.push_back(j);
+    }
+
+  }
+
+  return selected;
+
+}
+
+//' (C++) Subsequence Psi Dissimilarity Search via Dynamic Time Warping
+//' @description Finds the `k` segments of a long time series `x` most similar
+//' to a short pattern `y`, with subsequence dynamic time warping. The least
+//' cost path may start at any sample of `x` (open begin) and end at any sample
+//' of `x` (open end), instead of aligning the first and last samples of both
+//' time series as [cost_matrix_diagonal_cpp()] and its variants do, so all
+//' segments of `x` are searched in a single pass over a cost matrix with the
+//' samples of `y` as rows and the samples of `x` as columns, and only one
+//' column of the cost matrix is kept in memory.
+//'
+//' The psi score of the best match ending at each sample of `x` is computed
+//' as in [psi_dtw_cpp()], from the sum of distances of its least cost path and
+//' the auto sums of `y` and of the segment of `x`, and the same score is used
+//' to rank matches and is returned. Matches are then taken in order of
+//' increasing psi score, and skipped when they overlap a match taken before.
+//'
+//' With unweighted steps (`diagonal = FALSE`, or `weighted = FALSE`), the cost
+//' of each cell is the sum of distances of its least cost path, and the psi
+//' score of a match is the one of [psi_dtw_cpp()] with the segment of `x` as
+//' `x` and the pattern as `y` (up to rounding). With weighted diagonals, paths
+//' starting at earlier samples of `x` may lower the cost of cells of the
+//' segment and change the least cost path traced back from its end, so the psi
+//' score of a match may differ from the one of [psi_dtw_cpp()], except for
+//' exact copies of the pattern, with psi score zero.
+//' @param x (required, numeric matrix) long time series to search.
+//' @param y (required, numeric matrix) pattern, with the same number of columns
+//' as `x`.
+//' @param k (optional, integer) maximum number of non-overlapping matches to
+//' return. Default: 1
+//' @param distance (optional, character string) distance name from the "names"
+//' column of the dataset `distances` (see `distances$name`). Default: "euclidean"
+//' @param diagonal (optional, logical). If TRUE, diagonals are included in the
+//' computation of the cost matrix. Default: TRUE.
+//' @param weighted (optional, logical). Only relevant when diagonal is TRUE.
+//' When TRUE, diagonal cost is weighted by a factor of 1.414214. Default: TRUE.
+//' @return data frame with the columns "start" and "end" (first and last rows
+//' of the match in `x`) and "psi", ordered by psi score.
+//' @examples
+//' x <- zoo_simulate(
+//'   rows = 500,
+//'   cols = 2,
+//'   seed = 1
+//' )
+//'
+//' #pattern copied from x
+//' y <- x[201:240, ]
+//'
+//' psi_dtw_subsequence_cpp(
+//'   x = x,
+//'   y = y,
+//'   k = 3,
+//'   distance = "euclidean"
+//' )
+//' @family Rcpp_dissimilarity_analysis
+//' @export
+// [[Rcpp::export]]
+DataFrame psi_dtw_subsequence_cpp(
+    NumericMatrix x,
+    NumericMatrix y,
+    int k = 1,
+    const std::string& distance = "euclidean",
+    bool diagonal = true,
+    bool weighted = true
+){
+
+  if (x.ncol() != y.ncol()) {
+    Rcpp::stop("distantia::psi_dtw_subsequence_cpp(): arguments 'x' and 'y' must have the same number of columns.");
+  }
+
+  if (x.nrow() < 1 || y.nrow() < 1) {
+    Rcpp::stop("distantia::psi_dtw_subsequence_cpp(): arguments 'x' and 'y' must have at least one row.");
+  }
+
+  if (k < 1) {
+    Rcpp::stop("distantia::psi_dtw_subsequence_cpp(): argument 'k' must be a positive integer.");
+  }
+
+  DistanceFunctionRaw f = select_distance_function_raw(distance);
+
+  int xn = x.nrow();
+  int yn = y.nrow();
+  int cols = x.ncol();
+
+  std::vector<double> x_rows = matrix_rows_cpp(x);
+  std::vector<double> y_rows = matrix_rows_cpp(y);
+
+  std::vector<int> start;
+  std::vector<double> path_sum;
+  std::vector<double> segment_auto;
+
+  psi_dtw_subsequence_raw(
+    x_rows.data(),
+    xn,
+    y_rows.data(),
+    yn,
+    cols,
+    f,
+    diagonal,
+    weighted,
+    start,
+    path_sum,
+    segment_auto
+  );
+
+  // rounding to 8 decimal places
+  double factor = std::pow(10.0, 8);
+
+  //auto sum of y
+  double y_auto = 0.0;
+
+  for (int i = 0; i < yn - 1; ++i) {
+    y_auto += f(
+      y_rows.data() + static_cast<std::size_t>(i) * cols,
+      y_rows.data() + static_cast<std::size_t>(i + 1) * cols,
+      cols
+    );
+  }
+
+  y_auto = std::round(y_auto * factor) / factor;
+
+  //psi score of the best match ending at each sample of x, used both to
+  //rank and to report matches
+  std::vector<double> psi(xn);
+
+  for (int j = 0; j < xn; ++j) {
+    double a = std::round(path_sum[j] * factor) / factor;
+    double x_auto = std::round(segment_auto[j] * factor) / factor;
+    double b = std::round((x_auto + y_auto) * factor) / factor;
+    psi[j] = psi_equation_cpp(
+      a,
+      b,
+      diagonal
+    );
+  }
+
+  std::vector<int> selected = psi_dtw_subsequence_select(
+    start,
+    psi,
+    k
+  );
+
+  int n = static_cast<int>(selected.size());
+  IntegerVector out_start(n);
+  IntegerVector out_end(n);
+  NumericVector out_psi(n);
+
+  for (int i = 0; i < n; ++i) {
+
+    int j = selected[i];
+
+    out_start[i] = start[j] + 1;
+    out_end[i] = j + 1;
+    out_psi[i] = psi[j];
+
+  }
+
+  return DataFrame::create(
+    _["start"] = out_start,
+    _["end"] = out_end,
+    _["psi"] = out_psi
+  );
+
+}
@@ -0,0 +1,1107 @@
+#include <Rcpp.h>
+#include <cmath>
+#include <cstdio>
+#include <limits>
+#include <tuple>
+#include "distance_methods.h"
+#include "distance_matrix.h"
+#include "cost_matrix.h"
+#include "cost_path_raw.h"
+#include "auto_sum.h"
+#include "psi.h"
+#include "psi_tsl.h"
+#include "psi_bounds.h"
+#include "alignment_cache.h"
+#include "thread_pool.h"
+using namespace Rcpp;
+
+// Internal function to stage the time series of a list as row-major buffers.
+void tsl_series_cpp(
+    List tsl,
+    std::vector<TslSeries>& series
+){
+
+  series.resize(tsl.size());
+
+  for (int i = 0; i < tsl.size(); ++i) {
+
+    SEXP element = tsl[i];
+
+    if (!Rf_isMatrix(element) || !Rf_isNumeric(element)) {
+      Rcpp::stop("distantia::tsl_series_cpp(): all elements of 'tsl' must be numeric matrices.");
+    }
+
+    NumericMatrix m = as<NumericMatrix>(element);
+
+    series[i].rows = matrix_rows_cpp(m);
+    series[i].nrow = m.nrow();
+    series[i].ncol = m.ncol();
+    series[i].hash = alignment_hash_rows(series[i].rows.data(), m.nrow(), m.ncol());
+    series[i].mapped = nullptr;
+
+  }
+
+}
+
+// Internal function to get the prepared time series of `tsl`, either an
+// external pointer returned by tsl_prepare_cpp() or a list of matrices, which
+// is then staged into `local`.
+TslPrepared* tsl_prepared_cpp(
+    SEXP tsl,
+    TslPrepared& local,
+    const std::string& function_name
+){
+
+  if (TYPEOF(tsl) == EXTPTRSXP) {
+
+    if (!Rf_inherits(tsl, "tsl_prepared")) {
+      Rcpp::stop("distantia::" + function_name + "(): argument 'tsl' must be a list of matrices or the output of tsl_prepare_cpp() or tsl_binary_map_cpp().");
+    }
+
+    if (R_ExternalPtrAddr(tsl) == nullptr) {
+      Rcpp::stop("distantia::" + function_name + "(): the prepared time series list in 'tsl' is no longer valid (for example, after restoring a saved R session). Prepare it again with tsl_prepare_cpp().");
+    }
+
+    XPtr<TslPrepared> prepared(tsl);
+
+    return prepared.get();
+
+  }
+
+  tsl_series_cpp(as<List>(tsl), local.series);
+
+  return &local;
+
+}
+
+// Internal function to get the auto distances of the time series of a
+// prepared list, computing and caching the missing ones. `needed` flags the
+// combinations of time series and distance function to return, indexed as
+// `series * f.size() + function`, and `out` receives their values with the
+// same indexing.
+void tsl_prepared_auto_distance_cpp(
+    TslPrepared& prepared,
+    const std::vector<DistanceFunctionRaw>& f,
+    const std::vector<char>& needed,
+    int threads,
+    std::vector<double>& out
+){
+
+  int n_series = static_cast<int>(prepared.series.size());
+  int n_distances = static_cast<int>(f.size());
+
+  //cache entries created on the main thread
+  std::vector<AutoDistanceCache*> cache(n_distances);
+
+  for (int d = 0; d < n_distances; ++d) {
+
+    AutoDistanceCache& entry = prepared.auto_distance[f[d]];
+
+    if (entry.value.size() != static_cast<std::size_t>(n_series)) {
+      entry.value.assign(n_series, 0.0);
+      entry.ready.assign(n_series, 0);
+    }
+
+    cache[d] = &entry;
+
+  }
+
+  out.assign(needed.size(), 0.0);
+
+  parallel_for_cpp(
+    static_cast<int>(needed.size()),
+    threads,
+    [&](int k) {
+
+      if (!needed[k]) {
+        return;
+      }
+
+      int s = k / n_distances;
+      AutoDistanceCache& entry = *cache[k % n_distances];
+
+      if (!entry.ready[s]) {
+        entry.value[s] = tsl_auto_distance_cpp(
+          prepared.series[s],
+          f[k % n_distances]
+        );
+        entry.ready[s] = 1;
+      }
+
+      out[k] = entry.value[s];
+
+    }
+  );
+
+}
+
+// Internal function to convert 1-based indices of time series in a list
+// into 0-based indices, checking they are valid.
+std::vector<int> tsl_pair_index_cpp(
+    IntegerVector index,
+    int n,
+    const std::string& function_name,
+    const std::string& argument_name
+){
+
+  std::vector<int> out(index.size());
+
+  for (int i = 0; i < index.size(); ++i) {
+
+    if (index[i] == NA_INTEGER || index[i] < 1 || index[i] > n) {
+      Rcpp::stop(
+        "distantia::" + function_name + "(): values in '" + argument_name +
+          "' must be indices of time series in 'tsl'."
+      );
+    }
+
+    out[i] = index[i] - 1;
+
+  }
+
+  return out;
+
+}
+
+// Internal function to select the distance function of each pair. `distance`
+// has length one or `pairs`. Returns the index of the function of each pair
+// in `functions`, which holds each function once, even when given under
+// different names or abbreviations.
+std::vector<int> tsl_pair_distance_cpp(
+    CharacterVector distance,
+    int pairs,
+    std::vector<DistanceFunctionRaw>& functions
+){
+
+  std::vector<int> out(pairs, 0);
+
+  functions.clear();
+
+  if (distance.size() == 1) {
+    functions.push_back(select_distance_function_raw(as<std::string>(distance[0])));
+    return out;
+  }
+
+  for (int i = 0; i < pairs; ++i) {
+
+    DistanceFunctionRaw f = select_distance_function_raw(
+      as<std::string>(distance[i])
+    );
+
+    std::size_t d = std::find(
+      functions.begin(),
+      functions.end(),
+      f
+    ) - functions.begin();
+
+    if (d == functions.size()) {
+      functions.push_back(f);
+    }
+
+    out[i] = static_cast<int>(d);
+
+  }
+
+  return out;
+
+}
+
+// Internal function to sum the distances between consecutive samples of a
+// time series (see auto_distance_cpp()). Does not touch the R API.
+double tsl_auto_distance_cpp(
+    const TslSeries& x,
+    DistanceFunctionRaw f
+){
+
+  std::vector<int> from;
+  std::vector<int> to;
+
+  auto_sum_pairs_cpp(
+    x.nrow,
+    std::vector<int>(),
+    false,
+    from,
+    to
+  );
+
+  return auto_distance_rows_cpp(
+    x.data(),
+    x.ncol,
+    from,
+    to,
+    f
+  );
+
+}
+
+// Internal function to compute the psi scores of two time series with dynamic
+// time warping (see psi_dtw_cpp()) for several configurations of distance,
+// step pattern, and `bandwidth`. `distance` holds the index in `f` of the
+// distance function of each configuration, and `pattern` its StepPattern.
+// All configurations share the window of the cost matrix built from `window`
+// (see cost_window_spec_build()). The distance matrices of all functions in
+// `f` are computed in one sweep over pairs of rows (one at a time when
+// together they would exceed 4M cells), the cost matrix once per run of
+// consecutive configurations with the same distance and step pattern
+// (bandwidth only restricts the traceback of the least cost path), and one
+// psi score per configuration is written to `out`. Configurations whose last
+// cell of the cost matrix cannot be reached within the window receive NA. `x_auto` and `y_auto` are the
+// auto distances of the time series for each function in `f` (see
+// tsl_auto_distance_cpp()), and are ignored when `ignore_blocks` is true,
+// because they then depend on the least cost path. When the cache of least
+// cost paths is enabled (see alignment_cache_cpp()), paths are looked up
+// there first, and the distance and cost matrices are only computed for the
+// configurations not found. When `max_psi` is finite and `ignore_blocks` is
+// false, configurations whose psi score is higher than `max_psi` receive NA:
+// the ones with a lower bound higher than `max_psi` are not aligned (see
+// psi_dtw_lower_bound_cpp()), and the cost matrix of the others is abandoned
+// as soon as it proves their psi score is higher (see
+// psi_dtw_cost_abandon_cpp()). Does not touch the R API.
+void psi_dtw_sweep_cpp(
+    const TslSeries& x,
+    const TslSeries& y,
+    const std::vector<DistanceFunctionRaw>& f,
+    const std::vector<int>& distance,
+    const std::vector<int>& pattern,
+    const std::vector<double>& bandwidth,
+    const CostWindowSpec& window,
+    bool ignore_blocks,
+    const std::vector<double>& x_auto,
+    const std::vector<double>& y_auto,
+    DtwScratch& scratch,
+    double* out,
+    double max_psi
+){
+
+  int xn = x.nrow;
+  int yn = y.nrow;
+
+  std::size_t cells = static_cast<std::size_t>(yn) * xn;
+
+  //distance matrices of all functions computed in one sweep while they stay
+  //below 4M cells (32MB) together, one at a time otherwise
+  const std::size_t max_cells = 4194304;
+  bool fused = f.size() > 1 && cells * f.size() <= max_cells;
+
+  scratch.dist_matrix.resize(fused ? cells * f.size() : cells);
+  scratch.cost_matrix.resize(cells);
+
+  std::vector<double*> dist_matrices(f.size());
+
+  for (std::size_t k = 0; k < f.size(); ++k) {
+    dist_matrices[k] = scratch.dist_matrix.data() + (fused ? k * cells : 0);
+  }
+
+  //cells of the cost matrix computed for all configurations
+  const CostWindow* restricted = cost_window_spec_build(window, xn, yn, scratch.window);
+
+  bool cached = alignment_cache_enabled();
+  std::vector<char> dist_ready(f.size(), 0);
+
+  //similarity join: configurations above max_psi are discarded
+  bool filter = max_psi < std::numeric_limits<double>::infinity();
+  bool bounded = filter && !ignore_blocks;
+
+  //distance and step pattern of the cost matrix in scratch
+  int cost_distance = -1;
+  int cost_pattern = -1;
+
+  // rounding to 8 decimal places
+  double factor = std::pow(10.0, 8);
+
+  for (std::size_t c = 0; c < pattern.size(); ++c) {
+
+    int d = distance[c];
+    StepPattern pattern_c = static_cast<StepPattern>(pattern[c]);
+    bool diagonal_c = pattern_c != step_orthogonal;
+
+    double max_cost = std::numeric_limits<double>::infinity();
+
+    if (bounded) {
+
+      double b = std::round((x_auto[d] + y_auto[d]) * factor) / factor;
+
+      bool complete = psi_dtw_path_complete_cpp(
+        yn,
+        xn,
+        pattern_c,
+        restricted,
+        bandwidth[c]
+      );
+
+      double bound = psi_dtw_lower_bound_cpp(
+        x,
+        y,
+        f[d],
+        complete,
+        bandwidth[c],
+        b,
+        diagonal_c,
+        scratch.bounds
+      );
+
+      if (bound > max_psi) {
+        out[c] = R_NaReal;
+        continue;
+      }
+
+      if (complete) {
+        max_cost = psi_dtw_max_cost_cpp(max_psi, b, pattern_c);
+      }
+
+    }
+
+    AlignmentKey key;
+    bool found = false;
+
+    if (cached) {
+
+      key = alignment_key_cpp(
+        x.hash,
+        xn,
+        y.hash,
+        yn,
+        x.ncol,
+        f[d],
+        pattern_c,
+        restricted,
+        bandwidth[c]
+      );
+
+      found = alignment_cache_get(key, scratch.path);
+
+    }
+
+    if (!found) {
+
+      //cost matrix abandoned once no path can pass max_psi
+      if (
+          max_cost < std::numeric_limits<double>::infinity() &&
+            (d != cost_distance || pattern[c] != cost_pattern)
+      ) {
+
+        //the shared distance matrix is overwritten
+        if (!fused && !dist_ready[d]) {
+          std::fill(dist_ready.begin(), dist_ready.end(), 0);
+        }
+
+        bool completed = psi_dtw_cost_abandon_cpp(
+          x,
+          y,
+          f[d],
+          pattern_c,
+          restricted,
+          max_cost,
+          dist_ready[d] != 0,
+          dist_matrices[d],
+          scratch.cost_matrix.data(),
+          scratch.bounds
+        );
+
+        if (!completed) {
+          cost_distance = -1;
+          out[c] = R_NaReal;
+          continue;
+        }
+
+        dist_ready[d] = 1;
+        cost_distance = d;
+        cost_pattern = pattern[c];
+
+      }
+
+      if (!dist_ready[d] && (filter || !fused)) {
+
+        distance_matrix_raw(
+          x.data(),
+          xn,
+          y.data(),
+          yn,
+          x.ncol,
+          f[d],
+          dist_matrices[d],
+          1,
+          restricted
+        );
+
+        //the shared distance matrix now belongs to this function only
+        if (!fused) {
+          std::fill(dist_ready.begin(), dist_ready.end(), 0);
+        }
+
+        dist_ready[d] = 1;
+
+      } else if (!dist_ready[d]) {
+
+        distance_matrix_multi_raw(
+          x.data(),
+          xn,
+          y.data(),
+          yn,
+          x.ncol,
+          f,
+          dist_matrices
+        );
+
+        std::fill(dist_ready.begin(), dist_ready.end(), 1);
+
+      }
+
+      if (d != cost_distance || pattern[c] != cost_pattern) {
+
+        cost_matrix_batch(
+          dist_matrices[d],
+          scratch.cost_matrix.data(),
+          yn,
+          xn,
+          1,
+          pattern_c,
+          restricted
+        );
+
+        cost_distance = d;
+        cost_pattern = pattern[c];
+
+      }
+
+      //last cell out of reach within the window
+      if (std::isinf(scratch.cost_matrix[cells - 1])) {
+        out[c] = R_NaReal;
+        continue;
+      }
+
+      cost_path_raw(
+        dist_matrices[d],
+        scratch.cost_matrix.data(),
+        yn,
+        xn,
+        pattern_c,
+        bandwidth[c],
+        scratch.path
+      );
+
+      if (cached) {
+        alignment_cache_put(key, scratch.path);
+      }
+
+    }
+
+    double x_auto_c = x_auto[d];
+    double y_auto_c = y_auto[d];
+
+    if (ignore_blocks) {
+
+      cost_path_trim_raw(scratch.path);
+
+      //auto sums restricted to the samples in the least cost path
+      auto_sum_pairs_cpp(xn, scratch.path.x, true, scratch.from, scratch.to);
+      x_auto_c = auto_distance_rows_cpp(x.data(), x.ncol, scratch.from, scratch.to, f[d]);
+
+      auto_sum_pairs_cpp(yn, scratch.path.y, true, scratch.from, scratch.to);
+      y_auto_c = auto_distance_rows_cpp(y.data(), y.ncol, scratch.from, scratch.to, f[d]);
+
+    }
+
+    double a = cost_path_sum_raw(scratch.path);
+    double b = std::round((x_auto_c + y_auto_c) * factor) / factor;
+
+    out[c] = psi_equation_cpp(
+      a,
+      b,
+      diagonal_c
+    );
+
+    if (filter && out[c] > max_psi) {
+      out[c] = R_NaReal;
+    }
+
+  }
+
+}
+
+//' (C++) Content Hashes of the Time Series in a List
+//' @description Computes a 64-bit hash (FNV-1a) of the values and dimensions
+//' of each time series of a list, returned as a hexadecimal string. Time
+//' series with the same values have the same hash, regardless of their names
+//' or time index, and changing any value changes the hash. Used to identify
+//' time series in the result store of [distantia()] and in the cache of least
+//' cost paths (see [alignment_cache_cpp()]).
+//' @param tsl (required, list of numeric matrices) time series.
+//' @return named character vector.
+//' @examples
+//' tsl <- tsl_simulate(
+//'   n = 3,
+//'   seed = 1
+//' )
+//'
+//' tsl_hash_cpp(tsl = tsl)
+//' @family Rcpp_dissimilarity_analysis
+//' @export
+// [[Rcpp::export]]
+CharacterVector tsl_hash_cpp(
+    List tsl
+){
+
+  std::vector<TslSeries> series;
+
+  tsl_series_cpp(tsl, series);
+
+  CharacterVector hashes(series.size());
+
+  for (std::size_t i = 0; i < series.size(); ++i) {
+
+    char hash[17];
+    std::snprintf(hash, sizeof(hash), "%016llx", static_cast<unsigned long long>(series[i].hash));
+    hashes[i] = hash;
+
+  }
+
+  hashes.names() = tsl.names();
+
+  return hashes;
+
+}
+
+//' (C++) Prepare a Time Series List for Many Comparisons
+//' @description Converts the time series of a list once to the layout used by
+//' the C++ engines [psi_dtw_tsl_cpp()] and [psi_ls_tsl_cpp()], and returns an
+//' external pointer to the result, which these functions accept instead of
+//' the list. The auto sums of each time series are cached in the prepared
+//' object the first time they are needed for a distance, and reused by later
+//' calls, so a list prepared once can be compared many times in a long R
+//' session without converting the time series or recomputing their auto sums
+//' again. The auto sums of the distances in `distance` are computed upfront.
+//' External pointers do not survive saving and restoring an R session, and
+//' the list must then be prepared again.
+//' @param tsl (required, list of numeric matrices) time series.
+//' @param distance (optional, character vector) distance names from the
+//' "names" column of the dataset `distances` (see `distances$name`) whose
+//' auto sums are computed upfront. Default: NULL
+//' @param threads (optional, integer) number of threads. Values smaller than
+//' one use all available cores. Default: 1
+//' @return external pointer of class "tsl_prepared".
+//' @examples
+//' tsl <- tsl_simulate(
+//'   n = 4,
+//'   seed = 1
+//' )
+//'
+//' tsl_prepared <- tsl_prepare_cpp(
+//'   tsl = tsl,
+//'   distance = "euclidean"
+//' )
+//'
+//' psi_dtw_tsl_cpp(
+//'   tsl = tsl_prepared,
+//'   x = c(1L, 1L, 2L),
+//'   y = c(2L, 3L, 4L),
+//'   distance = "euclidean",
+//'   diagonal = TRUE,
+//'   bandwidth = 1
+//' )
+//' @family Rcpp_dissimilarity_analysis
+//' @export
+// [[Rcpp::export]]
+SEXP tsl_prepare_cpp(
+    List tsl,
+    Nullable<CharacterVector> distance = R_NilValue,
+    int threads = 1
+){
+
+  XPtr<TslPrepared> prepared(new TslPrepared(), true);
+
+  tsl_series_cpp(tsl, prepared->series);
+
+  if (distance.isNotNull()) {
+
+    CharacterVector distance_names(distance.get());
+    int n_series = static_cast<int>(prepared->series.size());
+
+    std::vector<DistanceFunctionRaw> distance_functions;
+
+    tsl_pair_distance_cpp(
+      distance_names,
+      distance_names.size(),
+      distance_functions
+    );
+
+    std::vector<char> needed(
+      static_cast<std::size_t>(n_series) * distance_functions.size(),
+      1
+    );
+
+    std::vector<double> auto_distance;
+
+    tsl_prepared_auto_distance_cpp(
+      *prepared,
+      distance_functions,
+      needed,
+      threads,
+      auto_distance
+    );
+
+  }
+
+  prepared.attr("class") = "tsl_prepared";
+
+  return prepared;
+
+}
+
+//' (C++) Psi Dissimilarity Scores of Many Pairs of Time Series via Dynamic Time Warping
+//' @description Computes the psi dissimilarity scores of many pairs of
+//' time series of a list in one call, with the results of [psi_dtw_cpp()].
+//' Time series are converted once to a layout adequate for distance
+//' computation, and auto sums are computed once per time series and distance.
+//' Pairs repeated with different values of `distance`, `diagonal`,
+//' `step_pattern`, or `bandwidth` (as in parameter sweeps) are aligned
+//' together: the distance matrices of all their distances are computed in one
+//' sweep over pairs of samples, and one cost matrix is computed per distance
+//' and step pattern. Pairs are distributed among C++ threads that take them one
+//' at a time, so long and short alignments are balanced across threads. Used by
+//' [distantia()] when no permutation tests are required.
+//' The arguments `distance`, `diagonal`, `bandwidth`, and `step_pattern` are
+//' either of length one or of the same length as `x` and `y`.
+//' @param tsl (required, list of numeric matrices or output of
+//' [tsl_prepare_cpp()] or [tsl_binary_map_cpp()]) time series with the same number of columns.
+//' @param x (required, integer vector) indices in `tsl` of the first time
+//' series of each pair.
+//' @param y (required, integer vector) indices in `tsl` of the second time
+//' series of each pair.
+//' @param distance (required, character vector) distance names from the
+//' "names" column of the dataset `distances` (see `distances$name`).
+//' @param diagonal (required, logical vector). If TRUE, diagonals are
+//' included in the computation of the cost matrix.
+//' @param bandwidth (required, numeric vector) Size of the Sakoe-Chiba band at
+//' both sides of the diagonal used to constrain the least cost path. Expressed
+//' as a fraction of the number of matrix rows and columns. Unrestricted when 1.
+//' Only restricts the traceback of the least cost path (see `window_size`).
+//' @param weighted (optional, logical). Only relevant when diagonal is TRUE.
+//' When TRUE, diagonal cost is weighted by a factor of 1.414214. Default: TRUE.
+//' @param ignore_blocks (optional, logical). If TRUE, blocks of consecutive path
+//' coordinates are trimmed to avoid inflating the psi distance. Default: FALSE.
+//' @param threads (optional, integer) number of threads. Values smaller than
+//' one use all available cores. Default: 1
+//' @param max_psi (optional, numeric) psi cutoff of a similarity join. If not
+//' NA, pairs with a psi score higher than `max_psi` receive NA. Pairs with a
+//' lower bound of their psi score higher than `max_psi` (see
+//' [psi_dtw_knn_cpp()]) are not aligned, and the cost matrix of the others is
+//' abandoned as soon as its lowest cost in a column proves the psi score is
+//' higher than `max_psi`, so most of the work on dissimilar pairs is skipped.
+//' Psi scores of the pairs below the cutoff are not affected. Default: NA
+//' @param step_pattern (optional, character vector) step patterns of the cost
+//' matrix and the least cost path (see [cost_path_cpp()]). If NULL, defined
+//' by `diagonal` and `weighted`, which are otherwise ignored. Default: NULL
+//' @param window (optional, character string) cells of the cost matrix
+//' computed by dynamic programming for all pairs, one of "none",
+//' "sakoe_chiba", or "itakura" (see [cost_path_cpp()]). Pairs whose last cell
+//' cannot be reached within the window receive NA. Default: "none"
+//' @param window_size (optional, numeric) size of the Sakoe-Chiba window at
+//' both sides of the diagonal, as a fraction of the number of rows of the
+//' second time series of each pair. Unlike `bandwidth`, it restricts the cost
+//' matrix itself. Only relevant when `window` is "sakoe_chiba". Default: 1
+//' @param slope (optional, numeric) maximum slope of the Itakura
+//' parallelogram, higher than one. Only relevant when `window` is "itakura".
+//' Default: 2
+//' @return numeric vector with one psi score per pair.
+//' @examples
+//' tsl <- tsl_simulate(
+//'   n = 4,
+//'   seed = 1
+//' )
+//'
+//' psi_dtw_tsl_cpp(
+//'   tsl = tsl,
+//'   x = c(1L, 1L, 2L),
+//'   y = c(2L, 3L, 4L),
+//'   distance = "euclidean",
+//'   diagonal = TRUE,
+//'   bandwidth = 1
+//' )
+//' @family Rcpp_dissimilarity_analysis
+//' @export
+// [[Rcpp::export]]
+NumericVector psi_dtw_tsl_cpp(
+    SEXP tsl,
+    IntegerVector x,
+    IntegerVector y,
+    CharacterVector distance,
+    LogicalVector diagonal,
+    NumericVector bandwidth,
+    bool weighted = true,
+    bool ignore_blocks = false,
+    int threads = 1,
+    double max_psi = NA_REAL,
+    Nullable<CharacterVector> step_pattern = R_NilValue,
+    const std::string& window = "none",
+    double window_size = 1,
+    double slope = 2
+){
+
+  int pairs = x.size();
+
+  if (y.size() != pairs) {
+    Rcpp::stop("distantia::psi_dtw_tsl_cpp(): arguments 'x' and 'y' must have the same length.");
+  }
+
+  CostWindowSpec window_spec = cost_window_spec_cpp(
+    window,
+    window_size,
+    slope,
+    "psi_dtw_tsl_cpp"
+  );
+
+  CharacterVector pattern_names;
+
+  if (step_pattern.isNotNull()) {
+
+    pattern_names = CharacterVector(step_pattern.get());
+
+    if (pattern_names.size() != 1 && pattern_names.size() != pairs) {
+      Rcpp::stop("distantia::psi_dtw_tsl_cpp(): argument 'step_pattern' must be NULL, or of length one or of the same length as 'x'.");
+    }
+
+  }
+
+  if (
+      (distance.size() != 1 && distance.size() != pairs) ||
+        (diagonal.size() != 1 && diagonal.size() != pairs) ||
+        (bandwidth.size() != 1 && bandwidth.size() != pairs)
+  ) {
+    Rcpp::stop("distantia::psi_dtw_tsl_cpp(): arguments 'distance', 'diagonal', and 'bandwidth' must be of length one or of the same length as 'x'.");
+  }
+
+  NumericVector psi(pairs);
+
+  if (pairs == 0) {
+    return psi;
+  }
+
+  TslPrepared local;
+  TslPrepared* prepared = tsl_prepared_cpp(tsl, local, "psi_dtw_tsl_cpp");
+  const std::vector<TslSeries>& series = prepared->series;
+  int n_series = static_cast<int>(series.size());
+
+  std::vector<int> x_index = tsl_pair_index_cpp(x, n_series, "psi_dtw_tsl_cpp", "x");
+  std::vector<int> y_index = tsl_pair_index_cpp(y, n_series, "psi_dtw_tsl_cpp", "y");
+
+  //distance functions, selected once per distance name
+  std::vector<DistanceFunctionRaw> distance_functions;
+  std::vector<int> pair_distance = tsl_pair_distance_cpp(
+    distance,
+    pairs,
+    distance_functions
+  );
+
+  for (int i = 0; i < pairs; ++i) {
+    if (series[x_index[i]].ncol != series[y_index[i]].ncol) {
+      Rcpp::stop("distantia::psi_dtw_tsl_cpp(): time series of each pair must have the same number of columns.");
+    }
+  }
+
+  std::vector<int> pair_pattern(pairs);
+  std::vector<double> pair_bandwidth(pairs);
+
+  for (int i = 0; i < pairs; ++i) {
+
+    if (pattern_names.size() > 0) {
+      pair_pattern[i] = cost_window_step_pattern_cpp(
+        Rcpp::as<std::string>(pattern_names[pattern_names.size() == 1 ? 0 : i]),
+        "psi_dtw_tsl_cpp"
+      );
+    } else {
+      pair_pattern[i] = cost_matrix_step_pattern(
+        diagonal[diagonal.size() == 1 ? 0 : i] == TRUE,
+        weighted
+      );
+    }
+
+    pair_bandwidth[i] = bandwidth[bandwidth.size() == 1 ? 0 : i];
+
+  }
+
+  //auto distances, once per time series and distance
+  int n_distances = static_cast<int>(distance_functions.size());
+
+  std::vector<char> needed(
+    static_cast<std::size_t>(n_series) * n_distances,
+    0
+  );
+
+  if (!ignore_blocks) {
+    for (int i = 0; i < pairs; ++i) {
+      needed[x_index[i] * n_distances + pair_distance[i]] = 1;
+      needed[y_index[i] * n_distances + pair_distance[i]] = 1;
+    }
+  }
+
+  std::vector<double> auto_distance;
+
+  tsl_prepared_auto_distance_cpp(
+    *prepared,
+    distance_functions,
+    needed,
+    threads,
+    auto_distance
+  );
+
+  //pairs grouped by time series: each group computes the distance matrices
+  //of all its distances in one sweep, and its configurations are sorted by
+  //distance and step pattern to share cost matrices
+  std::vector<int> order(pairs);
+
+  for (int i = 0; i < pairs; ++i) {
+    order[i] = i;
+  }
+
+  std::stable_sort(
+    order.begin(),
+    order.end(),
+    [&](int a, int b) {
+      return std::make_tuple(x_index[a], y_index[a], pair_distance[a], pair_pattern[a]) <
+        std::make_tuple(x_index[b], y_index[b], pair_distance[b], pair_pattern[b]);
+    }
+  );
+
+  std::vector<int> group_start;
+
+  for (int k = 0; k < pairs; ++k) {
+    if (
+        k == 0 ||
+          x_index[order[k]] != x_index[order[k - 1]] ||
+          y_index[order[k]] != y_index[order[k - 1]]
+    ) {
+      group_start.push_back(k);
+    }
+  }
+
+  int groups = static_cast<int>(group_start.size());
+  group_start.push_back(pairs);
+
+  //groups distributed among threads
+  std::vector<DtwScratch> scratch(resolve_threads_cpp(threads, groups));
+  std::vector<double> out(pairs);
+
+  parallel_for_worker_cpp(
+    groups,
+    threads,
+    [&](int g, int worker) {
+
+      int first = group_start[g];
+      int last = group_start[g + 1];
+      int xi = x_index[order[first]];
+      int yi = y_index[order[first]];
+
+      std::vector<DistanceFunctionRaw> group_functions;
+      std::vector<double> group_x_auto;
+      std::vector<double> group_y_auto;
+      std::vector<int> group_distance;
+      std::vector<int> group_pattern;
+      std::vector<double> group_bandwidth;
+
+      for (int k = first; k < last; ++k) {
+
+        int i = order[k];
+        int d = pair_distance[i];
+
+        //configurations are sorted by distance within the group
+        if (k == first || d != pair_distance[order[k - 1]]) {
+          group_functions.push_back(distance_functions[d]);
+          group_x_auto.push_back(auto_distance[xi * n_distances + d]);
+          group_y_auto.push_back(auto_distance[yi * n_distances + d]);
+        }
+
+        group_distance.push_back(static_cast<int>(group_functions.size()) - 1);
+        group_pattern.push_back(pair_pattern[i]);
+        group_bandwidth.push_back(pair_bandwidth[i]);
+
+      }
+
+      std::vector<double> group_psi(last - first);
+
+      psi_dtw_sweep_cpp(
+        series[xi],
+        series[yi],
+        group_functions,
+        group_distance,
+        group_pattern,
+        group_bandwidth,
+        window_spec,
+        ignore_blocks,
+        group_x_auto,
+        group_y_auto,
+        scratch[worker],
+        group_psi.data(),
+        std::isnan(max_psi) ? std::numeric_limits<double>::infinity() : max_psi
+      );
+
+      for (int k = first; k < last; ++k) {
+        out[order[k]] = group_psi[k - first];
+      }
+
+    }
+  );
+
+  std::copy(out.begin(), out.end(), psi.begin());
+
+  return psi;
+
+}
+
+//' (C++) Psi Dissimilarity Scores of Many Pairs of Aligned Time Series
+//' @description Computes the lock-step psi dissimilarity scores of many pairs
+//' of time series of a list in one call, with the results of [psi_ls_cpp()].
+//' All time series must have the same number of rows and columns. They are
+//' read from their row-major buffers (the ones of [tsl_prepare_cpp()] or the
+//' file mapping of [tsl_binary_map_cpp()], without copies), auto sums are
+//' computed once per time series and distance instead of once per pair, and
+//' pairs are distributed among C++ threads. Used by [distantia()] and
+//' [distantia_ls()] for lock-step comparisons.
+//' The argument `distance` is either of length one or of the same length as
+//' `x` and `y`.
+//' @param tsl (required, list of numeric matrices or output of
+//' [tsl_prepare_cpp()] or [tsl_binary_map_cpp()]) time series with the same number of rows and columns.
+//' @param x (required, integer vector) indices in `tsl` of the first time
+//' series of each pair.
+//' @param y (required, integer vector) indices in `tsl` of the second time
+//' series of each pair.
+//' @param distance (required, character vector) distance names from the
+//' "names" column of the dataset `distances` (see `distances$name`).
+//' @param threads (optional, integer) number of threads. Values smaller than
+//' one use all available cores. Default: 1
+//' @return numeric vector with one psi score per pair.
+//' @examples
+//' tsl <- tsl_simulate(
+//'   n = 4,
+//'   seed = 1
+//' )
+//'
+//' psi_ls_tsl_cpp(
+//'   tsl = tsl,
+//'   x = c(1L, 1L, 2L),
+//'   y = c(2L, 3L, 4L),
+//'   distance = "euclidean"
+//' )
+//' @family Rcpp_dissimilarity_analysis
+//' @export
+// [[Rcpp::export]]
+NumericVector psi_ls_tsl_cpp(
+    SEXP tsl,
+    IntegerVector x,
+    IntegerVector y,
+    CharacterVector distance,
+    int threads = 1
+){
+
+  int pairs = x.size();
+
+  if (y.size() != pairs) {
+    Rcpp::stop("distantia::psi_ls_tsl_cpp(): arguments 'x' and 'y' must have the same length.");
+  }
+
+  if (distance.size() != 1 && distance.size() != pairs) {
+    Rcpp::stop("distantia::psi_ls_tsl_cpp(): argument 'distance' must be of length one or of the same length as 'x'.");
+  }
+
+  NumericVector psi(pairs);
+
+  if (pairs == 0) {
+    return psi;
+  }
+
+  //prepared and mapped time series are read in place, and lists are
+  //staged once into row-major buffers
+  TslPrepared local;
+  TslPrepared* prepared = tsl_prepared_cpp(tsl, local, "psi_ls_tsl_cpp");
+
+  const std::vector<TslSeries>& series = prepared->series;
+
+  int n = static_cast<int>(series.size());
+  int nrow = n > 0 ? series[0].nrow : 0;
+  int ncol = n > 0 ? series[0].ncol : 0;
+
+  for (int s = 1; s < n; ++s) {
+    if (series[s].nrow != nrow || series[s].ncol != ncol) {
+      Rcpp::stop("distantia::psi_ls_tsl_cpp(): time series in 'tsl' must have the same number of rows and columns.");
+    }
+  }
+
+  std::vector<int> x_index = tsl_pair_index_cpp(x, n, "psi_ls_tsl_cpp", "x");
+  std::vector<int> y_index = tsl_pair_index_cpp(y, n, "psi_ls_tsl_cpp", "y");
+
+  std::vector<DistanceFunctionRaw> distance_functions;
+  std::vector<int> pair_distance = tsl_pair_distance_cpp(
+    distance,
+    pairs,
+    distance_functions
+  );
+
+  //auto distances, once per time series and distance
+  int n_distances = static_cast<int>(distance_functions.size());
+
+  std::vector<char> needed(
+    static_cast<std::size_t>(n) * n_distances,
+    0
+  );
+
+  for (int i = 0; i < pairs; ++i) {
+    needed[x_index[i] * n_distances + pair_distance[i]] = 1;
+    needed[y_index[i] * n_distances + pair_distance[i]] = 1;
+  }
+
+  std::vector<double> auto_distance(needed.size(), 0.0);
+
+  tsl_prepared_auto_distance_cpp(
+    *prepared,
+    distance_functions,
+    needed,
+    threads,
+    auto_distance
+  );
+
+  std::vector<double> out(pairs);
+
+  parallel_for_cpp(
+    pairs,
+    threads,
+    [&](int i) {
+
+      int d = pair_distance[i];
+      DistanceFunctionRaw f = distance_functions[d];
+
+      //lock-step sum of distances
+      const double* x_rows = series[x_index[i]].data();
+      const double* y_rows = series[y_index[i]].data();
+
+      double a = 0.0;
+
+      for (int t = 0; t < nrow; ++t) {
+        a += f(
+          y_rows + static_cast<std::size_t>(t) * ncol,
+          x_rows + static_cast<std::size_t>(t) * ncol,
+          ncol
+        );
+      }
+
+      // rounding to 8 decimal places
+      double factor = std::pow(10.0, 8);
+
+      double b = std::round(
+        (auto_distance[x_index[i] * n_distances + d] +
+          auto_distance[y_index[i] * n_distances + d]) * factor
+      ) / factor;
+
+      out[i] = psi_equation_cpp(
+        a,
+        b,
+        true
+      );
+
+    }
+  );
+
+  std::copy(out.begin(), out.end(), psi.begin());
+
+  return psi;
+
+}
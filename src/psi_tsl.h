@@ -0,0 +1,125 @@
+#ifndef PSI_TSL_H
+#define PSI_TSL_H
+
+#include <Rcpp.h>
+#include <map>
+#include <memory>
+#include <cstdint>
+#include <limits>
+#include <vector>
+#include "distance_methods.h"
+#include "cost_path_raw.h"
+#include "cost_window.h"
+
+// Time series of a list staged once as a row-major buffer, so each sample is
+// contiguous in memory and engines working on many pairs of time series do
+// not convert the same matrix once per pair. `hash` identifies its content
+// in the cache of least cost paths (see alignment_cache_cpp()). Time series
+// read from a binary time series list file (see tsl_binary_map_cpp()) leave
+// `rows` empty, and `mapped` points to their values in the file mapping.
+struct TslSeries {
+  std::vector<double> rows;
+  int nrow;
+  int ncol;
+  std::uint64_t hash;
+  const double* mapped = nullptr;
+
+  const double* data() const {
+    return mapped != nullptr ? mapped : rows.data();
+  }
+};
+
+// Auto distances of the time series of a prepared list for one distance
+// function, computed the first time they are needed.
+struct AutoDistanceCache {
+  std::vector<double> value;
+  std::vector<char> ready;
+};
+
+struct TslMapping;
+
+// Time series of a list prepared once to be compared many times (see
+// tsl_prepare_cpp()), with the auto distances computed so far. `mapping`
+// keeps the file mapping of time series read from a binary time series list
+// file alive.
+struct TslPrepared {
+  std::vector<TslSeries> series;
+  std::map<DistanceFunctionRaw, AutoDistanceCache> auto_distance;
+  std::shared_ptr<TslMapping> mapping;
+};
+
+// Reusable buffers of one thread computing lower bounds of psi scores (see
+// psi_dtw_lower_bound_cpp()).
+struct PsiBoundScratch {
+  std::vector<int> lo;
+  std::vector<int> hi;
+  std::vector<double> lower;
+  std::vector<double> upper;
+  std::vector<double> remaining;
+};
+
+// Reusable buffers of one thread aligning pairs of time series.
+struct DtwScratch {
+  std::vector<double> dist_matrix;
+  std::vector<double> cost_matrix;
+  CostPath path;
+  CostWindow window;
+  std::vector<int> from;
+  std::vector<int> to;
+  PsiBoundScratch bounds;
+};
+
+void tsl_series_cpp(
+    Rcpp::List tsl,
+    std::vector<TslSeries>& series
+);
+
+TslPrepared* tsl_prepared_cpp(
+    SEXP tsl,
+    TslPrepared& local,
+    const std::string& function_name
+);
+
+void tsl_prepared_auto_distance_cpp(
+    TslPrepared& prepared,
+    const std::vector<DistanceFunctionRaw>& f,
+    const std::vector<char>& needed,
+    int threads,
+    std::vector<double>& out
+);
+
+std::vector<int> tsl_pair_index_cpp(
+    Rcpp::IntegerVector index,
+    int n,
+    const std::string& function_name,
+    const std::string& argument_name
+);
+
+std::vector<int> tsl_pair_distance_cpp(
+    Rcpp::CharacterVector distance,
+    int pairs,
+    std::vector<DistanceFunctionRaw>& functions
+);
+
+double tsl_auto_distance_cpp(
+    const TslSeries& x,
+    DistanceFunctionRaw f
+);
+
+void psi_dtw_sweep_cpp(
+    const TslSeries& x,
+    const TslSeries& y,
+    const std::vector<DistanceFunctionRaw>& f,
+    const std::vector<int>& distance,
+    const std::vector<int>& pattern,
+    const std::vector<double>& bandwidth,
+    const CostWindowSpec& window,
+    bool ignore_blocks,
+    const std::vector<double>& x_auto,
+    const std::vector<double>& y_auto,
+    DtwScratch& scratch,
+    double* out,
+    double max_psi = std::numeric_limits<double>::infinity()
+);
+
+#endif // PSI_TSL_H
@@ -0,0 +1,117 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Number of threads to use for `tasks` independent tasks. Values of
+// `threads` smaller than one select all available cores.
+inline int resolve_threads_cpp(
+    int threads,
+    int tasks
+){
+
+  if (threads < 1) {
+    threads = static_cast<int>(std::thread::hardware_concurrency());
+  }
+
+  if (threads < 1) {
+    threads = 1;
+  }
+
+  return std::max(1, std::min(threads, tasks));
+
+}
+
+// Runs `task(i, worker)` for i in [0, tasks) on up to `threads` worker
+// threads, where `worker` in [0, resolve_threads_cpp(threads, tasks)) identifies
+// the thread running the task, and can be used to index per-thread scratch
+// buffers. Tasks are handed out one at a time from a shared counter, so threads
+// that finish early keep taking work (dynamic scheduling). The first exception
+// thrown by a task is rethrown in the calling thread once all workers stop.
+// Tasks must not touch the R API: they run outside of the main R thread.
+template <class Task>
+void parallel_for_worker_cpp(
+    int tasks,
+    int threads,
+    Task task
+){
+
+  threads = resolve_threads_cpp(threads, tasks);
+
+  if (threads <= 1) {
+    for (int i = 0; i < tasks; ++i) {
+      task(i, 0);
+    }
+    return;
+  }
+
+  std::atomic<int> next(0);
+  std::exception_ptr error = nullptr;
+  std::mutex error_mutex;
+
+  auto worker = [&](int w) {
+    for (;;) {
+
+      int i = next.fetch_add(1);
+
+      if (i >= tasks) {
+        return;
+      }
+
+      try {
+        task(i, w);
+      } catch (...) {
+        std::lock_guard<std::mutex> lock(error_mutex);
+        if (!error) {
+          error = std::current_exception();
+        }
+        //stop handing out new tasks
+        next.store(tasks);
+      }
+
+    }
+  };
+
+  std::vector<std::thread> pool;
+  pool.reserve(threads - 1);
+
+  for (int t = 1; t < threads; ++t) {
+    pool.emplace_back(worker, t);
+  }
+
+  //the calling thread works too
+  worker(0);
+
+  for (std::thread& thread : pool) {
+    thread.join();
+  }
+
+  if (error) {
+    std::rethrow_exception(error);
+  }
+
+}
+
+// Runs `task(i)` for i in [0, tasks) on up to `threads` worker threads
+// (see parallel_for_worker_cpp()).
+template <class Task>
+void parallel_for_cpp(
+    int tasks,
+    int threads,
+    Task task
+){
+
+  parallel_for_worker_cpp(
+    tasks,
+    threads,
+    [&](int i, int) { task(i); }
+  );
+
+}
+
+#endif // THREAD_POOL_H
@@ -0,0 +1,830 @@
+#include <Rcpp.h>
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <limits>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "distance_methods.h"
+#include "distance_matrix.h"
+#include "alignment.h"
+#include "cost_path_raw.h"
+#include "cost_window.h"
+#include "psi_tsl.h"
+#include "thread_pool.h"
+using namespace Rcpp;
+
+// Number of statistics of a time delay (see time_delay_stats_raw()).
+const int time_delay_stats = 7;
+
+// Internal function to compute the time delays between the samples of two
+// time series connected by a least cost path, as in distantia_time_delay().
+// Path coordinates are taken from the last cell to the first, and the ones
+// with a coordinate of `x` or `y` already seen are dropped. When more than 30
+// coordinates remain after removing 5 percent of them at each extreme, the
+// extremes are removed. Delays are `y_time - x_time` (`directional` is TRUE)
+// or their absolute value. Does not touch the R API.
+void time_delay_path_raw(
+    const CostPath& path,
+    int xn,
+    int yn,
+    const double* x_time,
+    const double* y_time,
+    bool directional,
+    std::vector<double>& delay
+){
+
+  std::vector<char> x_seen(xn, 0);
+  std::vector<char> y_seen(yn, 0);
+  std::vector<int> x_kept;
+  std::vector<int> y_kept;
+
+  for (std::size_t k = 0; k < path.x.size(); ++k) {
+
+    int x = path.x[k];
+    int y = path.y[k];
+
+    if (!x_seen[x] && !y_seen[y]) {
+      x_kept.push_back(x);
+      y_kept.push_back(y);
+    }
+
+    x_seen[x] = 1;
+    y_seen[y] = 1;
+
+  }
+
+  int kept = static_cast<int>(x_kept.size());
+
+  //5% padding, applied when 30 or more cases remain
+  int padding = static_cast<int>(std::ceil(kept / 100.0)) * 5;
+  int first = 0;
+  int last = kept - 1;
+
+  if (kept - padding * 2 >= 30) {
+    first = padding - 1;
+    last = kept - padding - 1;
+  }
+
+  delay.clear();
+
+  for (int k = first; k <= last; ++k) {
+    double d = y_time[y_kept[k]] - x_time[x_kept[k]];
+    delay.push_back(directional ? d : std::abs(d));
+  }
+
+}
+
+// Internal function to compute the statistics of a vector of time delays
+// returned by distantia_time_delay(): minimum, first quartile, median, mode,
+// mean, third quartile, and maximum, with the conventions of the R functions
+// quantile() (type 7), median(), and mean(). The mode is the most frequent
+// value, and the first one found in `delay` in case of ties. Writes them to
+// `out`, and NA when `delay` is empty. Does not touch the R API.
+void time_delay_stats_raw(
+    const std::vector<double>& delay,
+    double* out
+){
+
+  int n = static_cast<int>(delay.size());
+
+  if (n == 0) {
+    for (int s = 0; s < time_delay_stats; ++s) {
+      out[s] = NA_REAL;
+    }
+    return;
+  }
+
+  //mode, first value with the highest count
+  std::unordered_map<double, int> count;
+  double modal = delay[0];
+  int modal_count = 0;
+
+  for (double d : delay) {
+    count[d] += 1;
+  }
+
+  for (double d : delay) {
+    if (count[d] > modal_count) {
+      modal = d;
+      modal_count = count[d];
+    }
+  }
+
+  //mean with the refinement pass of mean()
+  long double sum = 0.0;
+
+  for (double d : delay) {
+    sum += d;
+  }
+
+  long double mean = sum / n;
+  long double correction = 0.0;
+
+  for (double d : delay) {
+    correction += d - mean;
+  }
+
+  mean += correction / n;
+
+  std::vector<double> sorted(delay);
+  std::sort(sorted.begin(), sorted.end());
+
+  auto quantile = [&](double p) -> double {
+    double index = (n - 1) * p;
+    int lo = static_cast<int>(std::floor(index));
+    int hi = static_cast<int>(std::ceil(index));
+    double h = index - lo;
+    if (h == 0.0 || sorted[hi] == sorted[lo]) {
+      return sorted[lo];
+    }
+    return (1.0 - h) * sorted[lo] + h * sorted[hi];
+  };
+
+  int half = (n + 1) / 2;
+  double median = n % 2 == 1 ?
+    sorted[half - 1] :
+    static_cast<double>((static_cast<long double>(sorted[half - 1]) + sorted[half]) / 2.0);
+
+  out[0] = sorted[0];
+  out[1] = quantile(0.25);
+  out[2] = median;
+  out[3] = modal;
+  out[4] = static_cast<double>(mean);
+  out[5] = quantile(0.75);
+  out[6] = sorted[n - 1];
+
+}
+
+// Methods to match the samples of two time series in time_delay_raw().
+enum TimeDelayMethod {
+  time_delay_dtw,
+  time_delay_xcorr,
+  time_delay_xcorr_dtw
+};
+
+// Internal function to translate the argument `method` of the time delay
+// functions.
+TimeDelayMethod time_delay_method_cpp(
+    const std::string& method,
+    const std::string& function_name
+){
+
+  if (method == "dtw") {
+    return time_delay_dtw;
+  }
+
+  if (method == "xcorr") {
+    return time_delay_xcorr;
+  }
+
+  if (method == "xcorr_dtw") {
+    return time_delay_xcorr_dtw;
+  }
+
+  Rcpp::stop("distantia::" + function_name + "(): argument 'method' must be one of 'dtw', 'xcorr', or 'xcorr_dtw'.");
+
+}
+
+// Buffers reused by time_delay_raw() across the pairs handled by a thread.
+struct TimeDelayBuffers {
+  Alignment alignment;
+  std::vector<double> delay;
+  std::vector<std::complex<double>> x_fft;
+  std::vector<std::complex<double>> y_fft;
+  std::vector<std::complex<double>> twiddle;
+  std::vector<double> dist_matrix;
+  std::vector<double> cost_matrix;
+};
+
+// Internal function to compute in place the discrete Fourier transform of
+// `a`, of length power of two, with the iterative radix-2 Cooley-Tukey
+// algorithm, or its inverse (scaled by the length) when `inverse` is TRUE.
+// `twiddle` holds the first half of the roots of unity of the length of `a`.
+// Does not touch the R API.
+void time_delay_fft_raw(
+    std::vector<std::complex<double>>& a,
+    const std::vector<std::complex<double>>& twiddle,
+    bool inverse
+){
+
+  int n = static_cast<int>(a.size());
+
+  //bit reversal permutation
+  for (int i = 1, j = 0; i < n; ++i) {
+    int bit = n >> 1;
+    for (; j & bit; bit >>= 1) {
+      j ^= bit;
+    }
+    j ^= bit;
+    if (i < j) {
+      std::swap(a[i], a[j]);
+    }
+  }
+
+  for (int len = 2; len <= n; len <<= 1) {
+
+    int half = len >> 1;
+    int step = n / len;
+
+    for (int i = 0; i < n; i += len) {
+      for (int k = 0; k < half; ++k) {
+        std::complex<double> w = inverse ? std::conj(twiddle[k * step]) : twiddle[k * step];
+        std::complex<double> u = a[i + k];
+        std::complex<double> v = a[i + k + half] * w;
+        a[i + k] = u + v;
+        a[i + k + half] = u - v;
+      }
+    }
+
+  }
+
+  if (inverse) {
+    for (std::complex<double>& v : a) {
+      v /= static_cast<double>(n);
+    }
+  }
+
+}
+
+// Internal function to find the lag `L` (samples of `y` ahead of the ones of
+// `x`, so sample `i` of `x` matches sample `i + L` of `y`) with the highest
+// cross-correlation between two time series stored as row-major buffers,
+// among lags with absolute value up to `max_lag`. Columns are z-normalized,
+// their cross-correlations at all lags are computed from fast Fourier
+// transforms of the zero-padded series, and added up. Ties go to the lag of
+// smallest absolute value, and then to the negative one. Does not touch the
+// R API.
+int time_delay_xcorr_raw(
+    const double* x_rows,
+    int xn,
+    const double* y_rows,
+    int yn,
+    int cols,
+    int max_lag,
+    TimeDelayBuffers& buffers
+){
+
+  int n = 1;
+  while (n < xn + yn - 1) {
+    n <<= 1;
+  }
+
+  std::vector<std::complex<double>>& fx = buffers.x_fft;
+  std::vector<std::complex<double>>& fy = buffers.y_fft;
+  std::vector<std::complex<double>>& twiddle = buffers.twiddle;
+
+  if (static_cast<int>(twiddle.size()) != n / 2) {
+    twiddle.resize(n / 2);
+    double angle = -2.0 * std::acos(-1.0) / n;
+    for (int k = 0; k < n / 2; ++k) {
+      twiddle[k] = std::polar(1.0, angle * k);
+    }
+  }
+
+  //cross-spectrum added over columns
+  std::vector<std::complex<double>> spectrum(n, 0.0);
+
+  auto load = [&](std::vector<std::complex<double>>& a, const double* rows, int rn, int c) {
+    double mean = 0.0;
+    for (int t = 0; t < rn; ++t) {
+      mean += rows[static_cast<std::size_t>(t) * cols + c];
+    }
+    mean /= rn;
+    double ss = 0.0;
+    for (int t = 0; t < rn; ++t) {
+      double v = rows[static_cast<std::size_t>(t) * cols + c] - mean;
+      ss += v * v;
+    }
+    //constant columns do not contribute
+    double scale = ss > 0.0 ? 1.0 / std::sqrt(ss / rn) : 0.0;
+    a.assign(n, 0.0);
+    for (int t = 0; t < rn; ++t) {
+      a[t] = (rows[static_cast<std::size_t>(t) * cols + c] - mean) * scale;
+    }
+  };
+
+  for (int c = 0; c < cols; ++c) {
+
+    load(fx, x_rows, xn, c);
+    load(fy, y_rows, yn, c);
+
+    time_delay_fft_raw(fx, twiddle, false);
+    time_delay_fft_raw(fy, twiddle, false);
+
+    for (int k = 0; k < n; ++k) {
+      spectrum[k] += std::conj(fx[k]) * fy[k];
+    }
+
+  }
+
+  //correlation at lag L in position L, or n + L for negative lags
+  time_delay_fft_raw(spectrum, twiddle, true);
+
+  int lag_min = -std::min(xn - 1, max_lag);
+  int lag_max = std::min(yn - 1, max_lag);
+
+  int best_lag = 0;
+  double best = -std::numeric_limits<double>::infinity();
+
+  for (int a = 0; a <= std::max(-lag_min, lag_max); ++a) {
+    int candidates[2] = {-a, a};
+    for (int c = a == 0 ? 1 : 0; c < 2; ++c) {
+      int lag = candidates[c];
+      if (lag < lag_min || lag > lag_max) {
+        continue;
+      }
+      double r = spectrum[lag < 0 ? n + lag : lag].real();
+      if (r > best) {
+        best = r;
+        best_lag = lag;
+      }
+    }
+  }
+
+  return best_lag;
+
+}
+
+// Internal function to compute the dynamic time warping least cost path
+// between two time series stored as row-major buffers within a band of cells
+// around the diagonal of offset `lag` (sample `i` of `x` against sample
+// `i + lag` of `y`), with `width` cells at each side. The band is widened to
+// include the first and last cells of the cost matrix, and only its cells are
+// computed, as a window of the cost matrix (see cost_matrix_batch()), with
+// diagonals weighted by 1.414214. Does not touch the R API.
+void time_delay_band_path_raw(
+    const double* x_rows,
+    int xn,
+    const double* y_rows,
+    int yn,
+    int cols,
+    DistanceFunctionRaw f,
+    int lag,
+    int width,
+    TimeDelayBuffers& buffers
+){
+
+  //offsets y - x of the cells in the band
+  int lo = std::max(-(xn - 1), std::min({lag - width, 0, yn - xn}));
+  int hi = std::min(yn - 1, std::max({lag + width, 0, yn - xn}));
+
+  CostWindow window;
+
+  cost_window_offset(
+    xn,
+    yn,
+    lo,
+    hi,
+    window
+  );
+
+  std::size_t cells = static_cast<std::size_t>(yn) * xn;
+  buffers.dist_matrix.resize(cells);
+  buffers.cost_matrix.resize(cells);
+
+  distance_matrix_raw(
+    x_rows,
+    xn,
+    y_rows,
+    yn,
+    cols,
+    f,
+    buffers.dist_matrix.data(),
+    1,
+    &window
+  );
+
+  cost_matrix_batch(
+    buffers.dist_matrix.data(),
+    buffers.cost_matrix.data(),
+    yn,
+    xn,
+    1,
+    step_weighted,
+    &window
+  );
+
+  cost_path_raw(
+    buffers.dist_matrix.data(),
+    buffers.cost_matrix.data(),
+    yn,
+    xn,
+    step_weighted,
+    1.0,
+    buffers.alignment.path
+  );
+
+  buffers.alignment.x_rows = xn;
+  buffers.alignment.y_rows = yn;
+
+}
+
+// Internal function to compute the statistics of the time delays between two
+// time series stored as row-major buffers (see distantia_time_delay()).
+// Samples are matched by the least cost path of dynamic time warping
+// ("dtw"), by the lag of highest cross-correlation ("xcorr"), or by the
+// least cost path within a band of `bandwidth` around that lag
+// ("xcorr_dtw"). Least cost paths are kept in C++ and never converted to a
+// data frame. Writes the statistics from `x` to `y` to `out`, followed by the
+// ones from `y` to `x` when `directional` is TRUE. Does not touch the R API.
+void time_delay_raw(
+    const double* x_rows,
+    int xn,
+    const double* y_rows,
+    int yn,
+    int cols,
+    const double* x_time,
+    const double* y_time,
+    DistanceFunctionRaw f,
+    TimeDelayMethod method,
+    double bandwidth,
+    bool directional,
+    TimeDelayBuffers& buffers,
+    double* out
+){
+
+  std::vector<double>& delay = buffers.delay;
+
+  //lags or band half-width in samples
+  double fraction = std::min(1.0, std::max(0.0, bandwidth));
+  int width = static_cast<int>(std::ceil(fraction * std::max(xn, yn)));
+
+  if (method == time_delay_xcorr) {
+
+    int lag = time_delay_xcorr_raw(
+      x_rows,
+      xn,
+      y_rows,
+      yn,
+      cols,
+      width,
+      buffers
+    );
+
+    //samples of x and y overlapping at the lag
+    delay.clear();
+
+    for (int i = std::max(0, -lag); i < std::min(xn, yn - lag); ++i) {
+      double d = y_time[i + lag] - x_time[i];
+      delay.push_back(directional ? d : std::abs(d));
+    }
+
+  } else {
+
+    if (method == time_delay_xcorr_dtw) {
+
+      int lag = time_delay_xcorr_raw(
+        x_rows,
+        xn,
+        y_rows,
+        yn,
+        cols,
+        std::max(xn, yn),
+        buffers
+      );
+
+      time_delay_band_path_raw(
+        x_rows,
+        xn,
+        y_rows,
+        yn,
+        cols,
+        f,
+        lag,
+        width,
+        buffers
+      );
+
+    } else {
+
+      alignment_compute_cpp(
+        x_rows,
+        xn,
+        y_rows,
+        yn,
+        cols,
+        f,
+        step_weighted,
+        NULL,
+        false,
+        bandwidth,
+        buffers.alignment
+      );
+
+    }
+
+    time_delay_path_raw(
+      buffers.alignment.path,
+      xn,
+      yn,
+      x_time,
+      y_time,
+      directional,
+      delay
+    );
+
+  }
+
+  time_delay_stats_raw(delay, out);
+
+  if (directional) {
+
+    //x_time - y_time, without negative zeros
+    for (double& d : delay) {
+      d = 0.0 - d;
+    }
+
+    time_delay_stats_raw(delay, out + time_delay_stats);
+
+  }
+
+}
+
+//' (C++) Time Delay Between Two Time Series
+//' @description Computes the statistics of the time delays between the
+//' samples of two time series connected by their dynamic time warping least
+//' cost path, as [distantia_time_delay()] does for each pair of time series.
+//' The least cost path is kept in C++, and duplicated coordinates, the 5
+//' percent of coordinates at each extreme of the path (when more than 30
+//' coordinates remain), the time differences, and their statistics are
+//' computed without building any intermediate data frame.
+//'
+//' For regular time series observed at the same times, the method "xcorr" is
+//' a fast approximation: the lag with the highest cross-correlation between
+//' the z-normalized columns of `x` and `y` is found in O(n log n) time with a
+//' fast Fourier transform, and the delays are the time differences between
+//' the samples of `x` and the ones of `y` at that lag. The method "xcorr_dtw"
+//' uses that lag to center a narrow band (of size `bandwidth`) where the
+//' least cost path is computed, so only the cells of the band are computed.
+//' @param x (required, numeric matrix) time series.
+//' @param y (required, numeric matrix) time series with the same number of
+//' columns as `x`.
+//' @param x_time (required, numeric vector) time of the samples of `x`.
+//' @param y_time (required, numeric vector) time of the samples of `y`, in the
+//' same units as `x_time`.
+//' @param distance (optional, character string) distance name from the "names"
+//' column of the dataset `distances` (see `distances$name`). Default: "euclidean"
+//' @param method (optional, character string) method to match the samples of
+//' `x` and `y`: "dtw" (least cost path of dynamic time warping), "xcorr" (lag
+//' of highest cross-correlation), or "xcorr_dtw" (least cost path within a
+//' band centered on the lag of highest cross-correlation). Default: "dtw"
+//' @param bandwidth (optional, numeric) Size of the Sakoe-Chiba band at both
+//' sides of the diagonal used to constrain the least cost path (method "dtw"),
+//' maximum absolute lag (method "xcorr"), or size of the band at both sides of
+//' the lag of highest cross-correlation (method "xcorr_dtw"). Expressed as a
+//' fraction of the number of rows of the longest time series. Default: 1
+//' @param directional (optional, logical) If TRUE, delays are `y_time - x_time`.
+//' Otherwise, their absolute value. Default: FALSE
+//' @return named numeric vector with the minimum ("min"), first quartile
+//' ("q1"), median ("median"), mode ("modal"), mean ("mean"), third quartile
+//' ("q3"), and maximum ("max") of the time delays from `x` to `y`.
+//' @examples
+//' x <- zoo_simulate(seed = 1)
+//' y <- zoo_simulate(seed = 2)
+//'
+//' time_delay_cpp(
+//'   x = x,
+//'   y = y,
+//'   x_time = as.numeric(zoo::index(x)),
+//'   y_time = as.numeric(zoo::index(y)),
+//'   directional = TRUE
+//' )
+//'
+//' #fast approximation
+//' time_delay_cpp(
+//'   x = x,
+//'   y = y,
+//'   x_time = as.numeric(zoo::index(x)),
+//'   y_time = as.numeric(zoo::index(y)),
+//'   method = "xcorr",
+//'   directional = TRUE
+//' )
+//' @family Rcpp_cost_path
+//' @export
+// [[Rcpp::export]]
+NumericVector time_delay_cpp(
+    NumericMatrix x,
+    NumericMatrix y,
+    NumericVector x_time,
+    NumericVector y_time,
+    const std::string& distance = "euclidean",
+    const std::string& method = "dtw",
+    double bandwidth = 1,
+    bool directional = false
+){
+
+  if (x.ncol() != y.ncol()) {
+    Rcpp::stop("distantia::time_delay_cpp(): 'x' and 'y' must have the same number of columns.");
+  }
+
+  if (x_time.size() != x.nrow() || y_time.size() != y.nrow()) {
+    Rcpp::stop("distantia::time_delay_cpp(): 'x_time' and 'y_time' must have one value per row of 'x' and 'y'.");
+  }
+
+  TimeDelayMethod m = time_delay_method_cpp(method, "time_delay_cpp");
+  DistanceFunctionRaw f = select_distance_function_raw(distance);
+
+  std::vector<double> x_rows = matrix_rows_cpp(x);
+  std::vector<double> y_rows = matrix_rows_cpp(y);
+
+  TimeDelayBuffers buffers;
+  std::vector<double> stats(time_delay_stats * 2);
+
+  time_delay_raw(
+    x_rows.data(),
+    x.nrow(),
+    y_rows.data(),
+    y.nrow(),
+    x.ncol(),
+    x_time.begin(),
+    y_time.begin(),
+    f,
+    m,
+    bandwidth,
+    directional,
+    buffers,
+    stats.data()
+  );
+
+  NumericVector out(stats.begin(), stats.begin() + time_delay_stats);
+  out.names() = CharacterVector::create("min", "q1", "median", "modal", "mean", "q3", "max");
+
+  return out;
+
+}
+
+//' (C++) Time Delays of Many Pairs of Time Series
+//' @description Computes the statistics of the time delays of many pairs of
+//' time series of a list in one call, with the results of
+//' [time_delay_cpp()]. Pairs are distributed among C++ threads. Used by
+//' [distantia_time_delay()].
+//' @param tsl (required, list of numeric matrices or output of
+//' [tsl_prepare_cpp()] or [tsl_binary_map_cpp()]) time series with the same
+//' number of columns.
+//' @param time (required, list of numeric vectors) time of the samples of each
+//' time series in `tsl`.
+//' @param x (required, integer vector) indices in `tsl` of the first time
+//' series of each pair.
+//' @param y (required, integer vector) indices in `tsl` of the second time
+//' series of each pair.
+//' @param samples (required, logical vector) of length one or of the same length
+//' as `x`. If TRUE, delays of the pair are computed in samples (row numbers)
+//' instead of `time`, for example, when the time units of the time series do
+//' not match.
+//' @param distance (optional, character string) distance name from the "names"
+//' column of the dataset `distances` (see `distances$name`). Default: "euclidean"
+//' @param method (optional, character string) method to match the samples of
+//' each pair, one of "dtw", "xcorr", or "xcorr_dtw" (see [time_delay_cpp()]).
+//' Default: "dtw"
+//' @param bandwidth (optional, numeric) Size of the Sakoe-Chiba band at both
+//' sides of the diagonal used to constrain the least cost path (method "dtw"),
+//' maximum absolute lag (method "xcorr"), or size of the band at both sides of
+//' the lag of highest cross-correlation (method "xcorr_dtw"). Expressed as a
+//' fraction of the number of rows of the longest time series of each pair.
+//' Default: 1
+//' @param directional (optional, logical) If TRUE, two rows are returned per
+//' pair, with the delays from `x` to `y` (`y_time - x_time`) and from `y` to
+//' `x`. Otherwise, one row with their absolute value. Default: FALSE
+//' @param threads (optional, integer) number of threads. Values smaller than
+//' one use all available cores. Default: 1
+//' @return numeric matrix with the columns "min", "q1", "median", "modal",
+//' "mean", "q3", and "max", and one row per pair, or two rows per pair (from
+//' `x` to `y` and from `y` to `x`) when `directional` is TRUE.
+//' @examples
+//' tsl <- tsl_simulate(
+//'   n = 3,
+//'   seed = 1
+//' )
+//'
+//' time_delay_tsl_cpp(
+//'   tsl = tsl,
+//'   time = lapply(tsl, function(x) as.numeric(zoo::index(x))),
+//'   x = c(1L, 1L, 2L),
+//'   y = c(2L, 3L, 3L),
+//'   samples = FALSE,
+//'   directional = TRUE
+//' )
+//' @family Rcpp_cost_path
+//' @export
+// [[Rcpp::export]]
+NumericMatrix time_delay_tsl_cpp(
+    SEXP tsl,
+    List time,
+    IntegerVector x,
+    IntegerVector y,
+    LogicalVector samples,
+    const std::string& distance = "euclidean",
+    const std::string& method = "dtw",
+    double bandwidth = 1,
+    bool directional = false,
+    int threads = 1
+){
+
+  int pairs = x.size();
+
+  if (y.size() != pairs) {
+    Rcpp::stop("distantia::time_delay_tsl_cpp(): arguments 'x' and 'y' must have the same length.");
+  }
+
+  if (samples.size() != 1 && samples.size() != pairs) {
+    Rcpp::stop("distantia::time_delay_tsl_cpp(): argument 'samples' must be of length one or of the same length as 'x'.");
+  }
+
+  TslPrepared local;
+  TslPrepared* prepared = tsl_prepared_cpp(tsl, local, "time_delay_tsl_cpp");
+  const std::vector<TslSeries>& series = prepared->series;
+  int n_series = static_cast<int>(series.size());
+
+  if (time.size() != n_series) {
+    Rcpp::stop("distantia::time_delay_tsl_cpp(): argument 'time' must have one element per time series in 'tsl'.");
+  }
+
+  std::vector<int> x_index = tsl_pair_index_cpp(x, n_series, "time_delay_tsl_cpp", "x");
+  std::vector<int> y_index = tsl_pair_index_cpp(y, n_series, "time_delay_tsl_cpp", "y");
+
+  //time of the samples, and row numbers for pairs with incompatible units
+  std::vector<std::vector<double>> series_time(n_series);
+  std::vector<std::vector<double>> series_rows(n_series);
+
+  for (int s = 0; s < n_series; ++s) {
+
+    NumericVector t = as<NumericVector>(time[s]);
+
+    if (t.size() != series[s].nrow) {
+      Rcpp::stop("distantia::time_delay_tsl_cpp(): each element of 'time' must have one value per row of the matching time series in 'tsl'.");
+    }
+
+    series_time[s].assign(t.begin(), t.end());
+    series_rows[s].resize(series[s].nrow);
+
+    for (int r = 0; r < series[s].nrow; ++r) {
+      series_rows[s][r] = r + 1;
+    }
+
+  }
+
+  for (int i = 0; i < pairs; ++i) {
+    if (series[x_index[i]].ncol != series[y_index[i]].ncol) {
+      Rcpp::stop("distantia::time_delay_tsl_cpp(): time series of each pair must have the same number of columns.");
+    }
+  }
+
+  std::vector<char> pair_samples(pairs);
+
+  for (int i = 0; i < pairs; ++i) {
+    pair_samples[i] = samples[samples.size() == 1 ? 0 : i] == TRUE;
+  }
+
+  TimeDelayMethod m = time_delay_method_cpp(method, "time_delay_tsl_cpp");
+  DistanceFunctionRaw f = select_distance_function_raw(distance);
+
+  int rows_per_pair = directional ? 2 : 1;
+  std::vector<double> stats(static_cast<std::size_t>(pairs) * rows_per_pair * time_delay_stats);
+
+  int workers = resolve_threads_cpp(threads, std::max(1, pairs));
+  std::vector<TimeDelayBuffers> buffers(workers);
+
+  parallel_for_worker_cpp(
+    pairs,
+    threads,
+    [&](int i, int w) {
+
+      const TslSeries& xs = series[x_index[i]];
+      const TslSeries& ys = series[y_index[i]];
+
+      const std::vector<std::vector<double>>& t = pair_samples[i] ? series_rows : series_time;
+
+      time_delay_raw(
+        xs.data(),
+        xs.nrow,
+        ys.data(),
+        ys.nrow,
+        xs.ncol,
+        t[x_index[i]].data(),
+        t[y_index[i]].data(),
+        f,
+        m,
+        bandwidth,
+        directional,
+        buffers[w],
+        stats.data() + static_cast<std::size_t>(i) * rows_per_pair * time_delay_stats
+      );
+
+    }
+  );
+
+  NumericMatrix out(pairs * rows_per_pair, time_delay_stats);
+
+  for (int r = 0; r < pairs * rows_per_pair; ++r) {
+    for (int s = 0; s < time_delay_stats; ++s) {
+      out(r, s) = stats[static_cast<std::size_t>(r) * time_delay_stats + s];
+    }
+  }
+
+  colnames(out) = CharacterVector::create("min", "q1", "median", "modal", "mean", "q3", "max");
+
+  return out;
+
+}
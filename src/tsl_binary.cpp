@@ -0,0 +1,585 @@
+#include <Rcpp.h>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include "distance_matrix.h"
+#include "alignment_cache.h"
+#include "psi_tsl.h"
+#include "tsl_binary.h"
+using namespace Rcpp;
+
+// Layout of binary time series list files:
+// - header of 64 bytes: magic string, format version, byte order mark, number
+//   of time series, and offset and size of the directory.
+// - one block per time series with its values as a row-major matrix of
+//   doubles, followed by a block with its time index as doubles. Blocks start
+//   at multiples of 64 bytes, so mapped values are aligned for vector loads.
+// - directory with the dimensions, block offsets, and content hash of each
+//   time series, and its name, time class, time zone, and column names.
+namespace {
+
+const char tsl_binary_magic[8] = {'D', 'T', 'S', 'L', 'B', 'I', 'N', '1'};
+const std::uint32_t tsl_binary_version = 1;
+const std::uint32_t tsl_binary_byte_order = 0x01020304;
+const std::size_t tsl_binary_header_size = 64;
+const std::size_t tsl_binary_alignment = 64;
+
+struct TslBinaryEntry {
+  std::uint64_t nrow;
+  std::uint64_t ncol;
+  std::uint64_t values_offset;
+  std::uint64_t time_offset;
+  std::uint64_t hash;
+  std::string name;
+  std::string time_class;
+  std::string time_zone;
+  std::vector<std::string> colnames;
+};
+
+std::size_t tsl_binary_aligned(std::size_t offset){
+  return (offset + tsl_binary_alignment - 1) / tsl_binary_alignment * tsl_binary_alignment;
+}
+
+// Sequential reader over a file mapping with bounds checks.
+struct TslBinaryReader {
+  const char* data;
+  std::size_t size;
+  std::size_t position;
+  bool valid;
+
+  template <class T>
+  T get(){
+    T value = T();
+    if (!valid || position + sizeof(T) > size) {
+      valid = false;
+      return value;
+    }
+    std::memcpy(&value, data + position, sizeof(T));
+    position += sizeof(T);
+    return value;
+  }
+
+  std::string get_string(){
+    std::uint64_t length = get<std::uint64_t>();
+    if (!valid || length > size - position) {
+      valid = false;
+      return std::string();
+    }
+    std::string value(data + position, static_cast<std::size_t>(length));
+    position += static_cast<std::size_t>(length);
+    return value;
+  }
+};
+
+template <class T>
+void tsl_binary_put(std::ofstream& out, T value){
+  out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+void tsl_binary_put_string(std::ofstream& out, const std::string& value){
+  tsl_binary_put<std::uint64_t>(out, value.size());
+  out.write(value.data(), value.size());
+}
+
+void tsl_binary_pad(std::ofstream& out, std::size_t& position, std::size_t target){
+  static const char zeros[tsl_binary_alignment] = {0};
+  while (position < target) {
+    std::size_t n = std::min(target - position, tsl_binary_alignment);
+    out.write(zeros, n);
+    position += n;
+  }
+}
+
+// Maps a binary time series list file and reads its directory.
+void tsl_binary_open(
+    const std::string& file,
+    const std::string& function_name,
+    std::shared_ptr<TslMapping>& mapping,
+    std::vector<TslBinaryEntry>& entries
+){
+
+  mapping = std::make_shared<TslMapping>();
+
+  if (!tsl_mapping_open(file, *mapping)) {
+    Rcpp::stop("distantia::" + function_name + "(): file '" + file + "' cannot be opened.");
+  }
+
+  std::string invalid = "distantia::" + function_name + "(): file '" + file + "' is not a valid binary time series list.";
+
+  if (mapping->size < tsl_binary_header_size ||
+      std::memcmp(mapping->address, tsl_binary_magic, sizeof(tsl_binary_magic)) != 0) {
+    Rcpp::stop(invalid);
+  }
+
+  TslBinaryReader header{mapping->address, mapping->size, sizeof(tsl_binary_magic), true};
+
+  std::uint32_t version = header.get<std::uint32_t>();
+  std::uint32_t byte_order = header.get<std::uint32_t>();
+  std::uint64_t n = header.get<std::uint64_t>();
+  std::uint64_t directory_offset = header.get<std::uint64_t>();
+  std::uint64_t directory_size = header.get<std::uint64_t>();
+
+  if (version != tsl_binary_version) {
+    Rcpp::stop("distantia::" + function_name + "(): file '" + file + "' was written by a newer version of distantia.");
+  }
+
+  if (byte_order != tsl_binary_byte_order) {
+    Rcpp::stop("distantia::" + function_name + "(): file '" + file + "' was written on a machine with a different byte order.");
+  }
+
+  if (directory_offset > mapping->size || directory_size > mapping->size - directory_offset) {
+    Rcpp::stop(invalid);
+  }
+
+  TslBinaryReader directory{
+    mapping->address,
+    static_cast<std::size_t>(directory_offset + directory_size),
+    static_cast<std::size_t>(directory_offset),
+    true
+  };
+
+  entries.assign(static_cast<std::size_t>(std::min<std::uint64_t>(n, directory_size)), TslBinaryEntry());
+
+  if (entries.size() != n) {
+    Rcpp::stop(invalid);
+  }
+
+  for (TslBinaryEntry& entry : entries) {
+
+    entry.nrow = directory.get<std::uint64_t>();
+    entry.ncol = directory.get<std::uint64_t>();
+    entry.values_offset = directory.get<std::uint64_t>();
+    entry.time_offset = directory.get<std::uint64_t>();
+    entry.hash = directory.get<std::uint64_t>();
+    entry.name = directory.get_string();
+    entry.time_class = directory.get_string();
+    entry.time_zone = directory.get_string();
+
+    if (!directory.valid || entry.ncol > directory_size) {
+      Rcpp::stop(invalid);
+    }
+
+    entry.colnames.resize(static_cast<std::size_t>(entry.ncol));
+
+    for (std::string& colname : entry.colnames) {
+      colname = directory.get_string();
+    }
+
+    std::uint64_t cells = entry.nrow * entry.ncol;
+
+    if (!directory.valid ||
+        entry.nrow > static_cast<std::uint64_t>(INT32_MAX) ||
+        entry.ncol > static_cast<std::uint64_t>(INT32_MAX) ||
+        (entry.ncol > 0 && cells / entry.ncol != entry.nrow) ||
+        entry.values_offset % sizeof(double) != 0 ||
+        entry.time_offset % sizeof(double) != 0 ||
+        entry.values_offset > mapping->size ||
+        cells > (mapping->size - entry.values_offset) / sizeof(double) ||
+        entry.time_offset > mapping->size ||
+        entry.nrow > (mapping->size - entry.time_offset) / sizeof(double)) {
+      Rcpp::stop(invalid);
+    }
+
+  }
+
+}
+
+}
+
+//' (C++) Write a Binary Time Series List File
+//' @description Internal function used by [tsl_write_binary()] to write the
+//' time series of a list to a binary file that can be memory-mapped with
+//' [tsl_binary_map_cpp()]. The values of each time series are stored as a
+//' row-major block of doubles aligned to 64 bytes, with its time index, name,
+//' column names, and content hash (see [tsl_hash_cpp()]). The file is
+//' written to a temporary file first, and then renamed.
+//' @param tsl (required, list of numeric matrices) time series.
+//' @param time (required, list of numeric vectors) time index of each time
+//' series, as numbers.
+//' @param colnames (required, list of character vectors) column names of each
+//' time series.
+//' @param names (required, character vector) names of the time series.
+//' @param time_class (required, character vector) class of the time index of
+//' each time series.
+//' @param time_zone (required, character vector) time zone of the time index
+//' of each time series, or empty strings.
+//' @param file (required, character string) path of the file to write.
+//' @return invisible NULL
+//' @family Rcpp_dissimilarity_analysis
+//' @export
+// [[Rcpp::export]]
+void tsl_binary_write_cpp(
+    List tsl,
+    List time,
+    List colnames,
+    CharacterVector names,
+    CharacterVector time_class,
+    CharacterVector time_zone,
+    const std::string& file
+){
+
+  int n = tsl.size();
+
+  if (time.size() != n || colnames.size() != n || names.size() != n ||
+      time_class.size() != n || time_zone.size() != n) {
+    Rcpp::stop("distantia::tsl_binary_write_cpp(): arguments 'tsl', 'time', 'colnames', 'names', 'time_class', and 'time_zone' must have the same length.");
+  }
+
+  std::vector<TslBinaryEntry> entries(n);
+  std::vector<std::vector<double>> rows(n);
+  std::vector<NumericVector> times(n);
+
+  std::size_t position = tsl_binary_header_size;
+
+  for (int i = 0; i < n; ++i) {
+
+    SEXP element = tsl[i];
+
+    if (!Rf_isMatrix(element) || !Rf_isNumeric(element)) {
+      Rcpp::stop("distantia::tsl_binary_write_cpp(): all elements of 'tsl' must be numeric matrices.");
+    }
+
+    NumericMatrix m = as<NumericMatrix>(element);
+    CharacterVector m_colnames = as<CharacterVector>(colnames[i]);
+
+    times[i] = as<NumericVector>(time[i]);
+
+    if (times[i].size() != m.nrow() || m_colnames.size() != m.ncol()) {
+      Rcpp::stop("distantia::tsl_binary_write_cpp(): the time index and column names of each time series must match its number of rows and columns.");
+    }
+
+    rows[i] = matrix_rows_cpp(m);
+
+    TslBinaryEntry& entry = entries[i];
+    entry.nrow = m.nrow();
+    entry.ncol = m.ncol();
+    entry.hash = alignment_hash_rows(rows[i].data(), m.nrow(), m.ncol());
+    entry.name = as<std::string>(names[i]);
+    entry.time_class = as<std::string>(time_class[i]);
+    entry.time_zone = as<std::string>(time_zone[i]);
+
+    for (int j = 0; j < m_colnames.size(); ++j) {
+      entry.colnames.push_back(as<std::string>(m_colnames[j]));
+    }
+
+    entry.values_offset = position;
+    position = tsl_binary_aligned(position + rows[i].size() * sizeof(double));
+
+    entry.time_offset = position;
+    position = tsl_binary_aligned(position + m.nrow() * sizeof(double));
+
+  }
+
+  std::size_t directory_offset = position;
+
+  std::string file_tmp = file + ".tmp";
+  std::ofstream out(file_tmp.c_str(), std::ios::binary | std::ios::trunc);
+
+  if (!out) {
+    Rcpp::stop("distantia::tsl_binary_write_cpp(): file '" + file + "' cannot be written.");
+  }
+
+  //header
+  out.write(tsl_binary_magic, sizeof(tsl_binary_magic));
+  tsl_binary_put<std::uint32_t>(out, tsl_binary_version);
+  tsl_binary_put<std::uint32_t>(out, tsl_binary_byte_order);
+  tsl_binary_put<std::uint64_t>(out, n);
+  tsl_binary_put<std::uint64_t>(out, directory_offset);
+
+  //directory size, filled in after writing the directory
+  std::streampos directory_size_position = out.tellp();
+  tsl_binary_put<std::uint64_t>(out, 0);
+
+  position = static_cast<std::size_t>(out.tellp());
+  tsl_binary_pad(out, position, tsl_binary_header_size);
+
+  //value and time blocks
+  for (int i = 0; i < n; ++i) {
+
+    tsl_binary_pad(out, position, entries[i].values_offset);
+    out.write(reinterpret_cast<const char*>(rows[i].data()), rows[i].size() * sizeof(double));
+    position += rows[i].size() * sizeof(double);
+
+    tsl_binary_pad(out, position, entries[i].time_offset);
+    out.write(reinterpret_cast<const char*>(times[i].begin()), times[i].size() * sizeof(double));
+    position += times[i].size() * sizeof(double);
+
+  }
+
+  tsl_binary_pad(out, position, directory_offset);
+
+  //directory
+  for (const TslBinaryEntry& entry : entries) {
+
+    tsl_binary_put<std::uint64_t>(out, entry.nrow);
+    tsl_binary_put<std::uint64_t>(out, entry.ncol);
+    tsl_binary_put<std::uint64_t>(out, entry.values_offset);
+    tsl_binary_put<std::uint64_t>(out, entry.time_offset);
+    tsl_binary_put<std::uint64_t>(out, entry.hash);
+    tsl_binary_put_string(out, entry.name);
+    tsl_binary_put_string(out, entry.time_class);
+    tsl_binary_put_string(out, entry.time_zone);
+
+    for (const std::string& colname : entry.colnames) {
+      tsl_binary_put_string(out, colname);
+    }
+
+  }
+
+  std::uint64_t directory_size = static_cast<std::uint64_t>(out.tellp()) - directory_offset;
+
+  out.seekp(directory_size_position);
+  tsl_binary_put<std::uint64_t>(out, directory_size);
+  out.close();
+
+  if (!out) {
+    std::remove(file_tmp.c_str());
+    Rcpp::stop("distantia::tsl_binary_write_cpp(): file '" + file + "' cannot be written.");
+  }
+
+  std::remove(file.c_str());
+
+  if (std::rename(file_tmp.c_str(), file.c_str()) != 0) {
+    std::remove(file_tmp.c_str());
+    Rcpp::stop("distantia::tsl_binary_write_cpp(): file '" + file + "' cannot be written.");
+  }
+
+}
+
+//' (C++) Memory-Map a Binary Time Series List File
+//' @description Maps a binary time series list file written by
+//' [tsl_write_binary()] into memory, and returns it as a prepared time series
+//' list (see [tsl_prepare_cpp()]) accepted by [psi_dtw_tsl_cpp()] and
+//' [psi_ls_tsl_cpp()]. Only the directory of the file is read. The values of
+//' the time series are not copied: the C++ engines read them directly from
+//' the mapping, and the operating system loads the parts of the file they
+//' touch on demand, so files larger than the available memory can be
+//' analyzed. Time series are indexed as in the file (see
+//' [tsl_binary_info_cpp()]).
+//' @param file (required, character string) path of a binary time series list
+//' file.
+//' @return external pointer of class "tsl_prepared".
+//' @examples
+//' tsl <- tsl_simulate(
+//'   n = 4,
+//'   seed = 1
+//' )
+//'
+//' file <- tempfile(fileext = ".tslbin")
+//'
+//' tsl_write_binary(
+//'   tsl = tsl,
+//'   file = file
+//' )
+//'
+//' tsl_mapped <- tsl_binary_map_cpp(file = file)
+//'
+//' psi_dtw_tsl_cpp(
+//'   tsl = tsl_mapped,
+//'   x = c(1L, 1L, 2L),
+//'   y = c(2L, 3L, 4L),
+//'   distance = "euclidean",
+//'   diagonal = TRUE,
+//'   bandwidth = 1
+//' )
+//' @family Rcpp_dissimilarity_analysis
+//' @export
+// [[Rcpp::export]]
+SEXP tsl_binary_map_cpp(
+    const std::string& file
+){
+
+  std::shared_ptr<TslMapping> mapping;
+  std::vector<TslBinaryEntry> entries;
+
+  tsl_binary_open(file, "tsl_binary_map_cpp", mapping, entries);
+
+  XPtr<TslPrepared> prepared(new TslPrepared(), true);
+
+  prepared->mapping = mapping;
+  prepared->series.resize(entries.size());
+
+  for (std::size_t i = 0; i < entries.size(); ++i) {
+
+    TslSeries& series = prepared->series[i];
+    series.nrow = static_cast<int>(entries[i].nrow);
+    series.ncol = static_cast<int>(entries[i].ncol);
+    series.hash = entries[i].hash;
+    series.mapped = reinterpret_cast<const double*>(
+      mapping->address + entries[i].values_offset
+    );
+
+  }
+
+  prepared.attr("class") = "tsl_prepared";
+
+  return prepared;
+
+}
+
+//' (C++) Contents of a Binary Time Series List File
+//' @description Reads the directory of a binary time series list file
+//' written by [tsl_write_binary()], without reading the time series.
+//' @param file (required, character string) path of a binary time series list
+//' file.
+//' @return data frame with the columns `name`, `rows`, `columns`,
+//' `time_class`, and `hash` (see [tsl_hash_cpp()]), with one row per time
+//' series, in the order of the file.
+//' @examples
+//' tsl <- tsl_simulate(
+//'   n = 4,
+//'   seed = 1
+//' )
+//'
+//' file <- tempfile(fileext = ".tslbin")
+//'
+//' tsl_write_binary(
+//'   tsl = tsl,
+//'   file = file
+//' )
+//'
+//' tsl_binary_info_cpp(file = file)
+//' @family Rcpp_dissimilarity_analysis
+//' @export
+// [[Rcpp::export]]
+DataFrame tsl_binary_info_cpp(
+    const std::string& file
+){
+
+  std::shared_ptr<TslMapping> mapping;
+  std::vector<TslBinaryEntry> entries;
+
+  tsl_binary_open(file, "tsl_binary_info_cpp", mapping, entries);
+
+  int n = entries.size();
+
+  CharacterVector name(n);
+  IntegerVector rows(n);
+  IntegerVector columns(n);
+  CharacterVector time_class(n);
+  CharacterVector hash(n);
+
+  for (int i = 0; i < n; ++i) {
+
+    char hash_i[17];
+    std::snprintf(hash_i, sizeof(hash_i), "%016llx", static_cast<unsigned long long>(entries[i].hash));
+
+    name[i] = entries[i].name;
+    rows[i] = static_cast<int>(entries[i].nrow);
+    columns[i] = static_cast<int>(entries[i].ncol);
+    time_class[i] = entries[i].time_class;
+    hash[i] = hash_i;
+
+  }
+
+  return DataFrame::create(
+    _["name"] = name,
+    _["rows"] = rows,
+    _["columns"] = columns,
+    _["time_class"] = time_class,
+    _["hash"] = hash,
+    _["stringsAsFactors"] = false
+  );
+
+}
+
+//' (C++) Read Time Series From a Binary Time Series List File
+//' @description Internal function used by [tsl_read_binary()] to copy time
+//' series from a binary time series list file into R. Only the pages of the
+//' file holding the selected time series are read.
+//' @param file (required, character string) path of a binary time series list
+//' file.
+//' @param names (optional, character vector) names of the time series to
+//' read. If NULL, all time series are read. Default: NULL
+//' @return named list with one element per time series, with the elements
+//' `x` (numeric matrix), `time` (numeric vector), `time_class`, and
+//' `time_zone`.
+//' @family Rcpp_dissimilarity_analysis
+//' @export
+// [[Rcpp::export]]
+List tsl_binary_read_cpp(
+    const std::string& file,
+    Nullable<CharacterVector> names = R_NilValue
+){
+
+  std::shared_ptr<TslMapping> mapping;
+  std::vector<TslBinaryEntry> entries;
+
+  tsl_binary_open(file, "tsl_binary_read_cpp", mapping, entries);
+
+  std::vector<int> selected;
+
+  if (names.isNotNull()) {
+
+    CharacterVector names_vector(names.get());
+
+    for (int k = 0; k < names_vector.size(); ++k) {
+
+      std::string name_k = as<std::string>(names_vector[k]);
+      int found = -1;
+
+      for (std::size_t i = 0; i < entries.size(); ++i) {
+        if (entries[i].name == name_k) {
+          found = static_cast<int>(i);
+          break;
+        }
+      }
+
+      if (found < 0) {
+        Rcpp::stop("distantia::tsl_binary_read_cpp(): time series '" + name_k + "' is not in file '" + file + "'.");
+      }
+
+      selected.push_back(found);
+
+    }
+
+  } else {
+
+    for (std::size_t i = 0; i < entries.size(); ++i) {
+      selected.push_back(static_cast<int>(i));
+    }
+
+  }
+
+  List out(selected.size());
+  CharacterVector out_names(selected.size());
+
+  for (std::size_t k = 0; k < selected.size(); ++k) {
+
+    const TslBinaryEntry& entry = entries[selected[k]];
+
+    int nrow = static_cast<int>(entry.nrow);
+    int ncol = static_cast<int>(entry.ncol);
+
+    const double* values = reinterpret_cast<const double*>(mapping->address + entry.values_offset);
+    const double* time_values = reinterpret_cast<const double*>(mapping->address + entry.time_offset);
+
+    //row-major block to column-major matrix
+    NumericMatrix x(nrow, ncol);
+
+    for (int i = 0; i < nrow; ++i) {
+      for (int j = 0; j < ncol; ++j) {
+        x(i, j) = values[static_cast<std::size_t>(i) * ncol + j];
+      }
+    }
+
+    colnames(x) = CharacterVector(entry.colnames.begin(), entry.colnames.end());
+
+    out[k] = List::create(
+      _["x"] = x,
+      _["time"] = NumericVector(time_values, time_values + nrow),
+      _["time_class"] = entry.time_class,
+      _["time_zone"] = entry.time_zone
+    );
+
+    out_names[k] = entry.name;
+
+  }
+
+  out.names() = out_names;
+
+  return out;
+
+}
@@ -0,0 +1,29 @@
+#ifndef TSL_BINARY_H
+#define TSL_BINARY_H
+
+#include <cstddef>
+#include <string>
+
+// Read-only memory mapping of a binary time series list file (see
+// tsl_binary_write_cpp()). The operating system reads pages of the file on
+// demand when they are accessed, and the file is unmapped when the mapping is
+// destroyed. Implemented without the R API in tsl_mapping.cpp, because the
+// Windows headers conflict with the ones of R.
+struct TslMapping {
+  const char* address = nullptr;
+  std::size_t size = 0;
+  void* file_handle = nullptr;
+  void* map_handle = nullptr;
+
+  TslMapping() = default;
+  TslMapping(const TslMapping&) = delete;
+  TslMapping& operator=(const TslMapping&) = delete;
+  ~TslMapping();
+};
+
+bool tsl_mapping_open(
+    const std::string& file,
+    TslMapping& mapping
+);
+
+#endif // TSL_BINARY_H
@@ -0,0 +1,109 @@
+#include "tsl_binary.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Internal function to map a file read-only into memory. Returns false when
+// the file cannot be opened or mapped. Does not touch the R API.
+bool tsl_mapping_open(
+    const std::string& file,
+    TslMapping& mapping
+){
+
+#ifdef _WIN32
+
+  HANDLE file_handle = CreateFileA(
+    file.c_str(),
+    GENERIC_READ,
+    FILE_SHARE_READ,
+    NULL,
+    OPEN_EXISTING,
+    FILE_ATTRIBUTE_NORMAL,
+    NULL
+  );
+
+  if (file_handle == INVALID_HANDLE_VALUE) {
+    return false;
+  }
+
+  LARGE_INTEGER size;
+
+  if (!GetFileSizeEx(file_handle, &size) || size.QuadPart == 0) {
+    CloseHandle(file_handle);
+    return false;
+  }
+
+  HANDLE map_handle = CreateFileMappingA(file_handle, NULL, PAGE_READONLY, 0, 0, NULL);
+
+  if (map_handle == NULL) {
+    CloseHandle(file_handle);
+    return false;
+  }
+
+  void* address = MapViewOfFile(map_handle, FILE_MAP_READ, 0, 0, 0);
+
+  if (address == NULL) {
+    CloseHandle(map_handle);
+    CloseHandle(file_handle);
+    return false;
+  }
+
+  mapping.address = static_cast<const char*>(address);
+  mapping.size = static_cast<std::size_t>(size.QuadPart);
+  mapping.file_handle = file_handle;
+  mapping.map_handle = map_handle;
+
+#else
+
+  int fd = open(file.c_str(), O_RDONLY);
+
+  if (fd < 0) {
+    return false;
+  }
+
+  struct stat info;
+
+  if (fstat(fd, &info) != 0 || info.st_size == 0) {
+    close(fd);
+    return false;
+  }
+
+  void* address = mmap(nullptr, static_cast<std::size_t>(info.st_size), PROT_READ, MAP_SHARED, fd, 0);
+
+  //the mapping stays valid after closing the file descriptor
+  close(fd);
+
+  if (address == MAP_FAILED) {
+    return false;
+  }
+
+  mapping.address = static_cast<const char*>(address);
+  mapping.size = static_cast<std::size_t>(info.st_size);
+
+#endif
+
+  return true;
+
+}
+
+TslMapping::~TslMapping(){
+
+  if (address == nullptr) {
+    return;
+  }
+
+#ifdef _WIN32
+  UnmapViewOfFile(address);
+  CloseHandle(static_cast<HANDLE>(map_handle));
+  CloseHandle(static_cast<HANDLE>(file_handle));
+#else
+  munmap(const_cast<char*>(address), size);
+#endif
+
+}